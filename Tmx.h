@@ -28,6 +28,7 @@
 #pragma once
 
 #include "TmxMap.h"
+#include "TmxMapInfo.h"
 #include "TmxTileset.h"
 #include "TmxTile.h"
 #include "TmxImage.h"
@@ -37,4 +38,5 @@
 #include "TmxPolygon.h"
 #include "TmxPolyline.h"
 #include "TmxPropertySet.h"
+#include "TmxSnapshot.h"
 #include "TmxUtil.h"
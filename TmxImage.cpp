@@ -27,6 +27,7 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxImage.h"
+#include "TmxSnapshot.h"
 
 namespace Tmx 
 {	
@@ -37,9 +38,6 @@ namespace Tmx
 		, transparent_color()
 	{}
 
-	Image::~Image() 
-	{}
-
 	void Image::Parse(const TiXmlNode *imageNode) 
 	{
 		const TiXmlElement* imageElem = imageNode->ToElement();
@@ -56,4 +54,20 @@ namespace Tmx
 			transparent_color = trans;
 		}
 	}
+
+	void Image::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteString(source);
+		writer.WriteInt(width);
+		writer.WriteInt(height);
+		writer.WriteString(transparent_color);
+	}
+
+	void Image::Load(SnapshotReader &reader) 
+	{
+		source = reader.ReadString();
+		width = reader.ReadInt();
+		height = reader.ReadInt();
+		transparent_color = reader.ReadString();
+	}
 };
@@ -33,6 +33,9 @@ class TiXmlNode;
 
 namespace Tmx 
 {
+	class SnapshotReader;
+	class SnapshotWriter;
+
 	//-------------------------------------------------------------------------
 	// An image within a tileset.
 	//-------------------------------------------------------------------------
@@ -40,11 +43,16 @@ namespace Tmx
 	{
 	public:
 		Image();
-		~Image();
 
 		// Parses an image element.
 		void Parse(const TiXmlNode *imageNode);
 
+		// Write the image into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the image back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
+
 		// Get the path to the file of the image (relative to the map)
 		const std::string &GetSource() const { return source; }
 
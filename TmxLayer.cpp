@@ -26,17 +26,65 @@
 // Author: Tamir Atias
 //-----------------------------------------------------------------------------
 #include <zlib.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 
 #include "tinyxml.h"
 #include "TmxLayer.h"
+#include "TmxSnapshot.h"
 #include "TmxUtil.h"
 #include "TmxMap.h"
 #include "TmxTileset.h"
 
 namespace Tmx 
 {
+	// Tile returned for positions not covered by any chunk.
+	static const MapTile emptyTile(0, 0, -1);
+
+	// Size of a tile in a snapshot: tileset id, id and the flip flags.
+	static const int snapshotTileSize = 3 * sizeof(int);
+
+	// Write tiles field by field, so the padding of MapTile never ends up in a snapshot.
+	static void SaveTiles(SnapshotWriter &writer, const MapTile *tiles, int count) 
+	{
+		std::vector< int > fields(count * 3);
+		for (int i = 0; i < count; i++) 
+		{
+			fields[i * 3] = tiles[i].tilesetId;
+			fields[i * 3 + 1] = (int)tiles[i].id;
+			fields[i * 3 + 2] = (tiles[i].flippedHorizontally ? 1 : 0) | 
+				(tiles[i].flippedVertically ? 2 : 0) | 
+				(tiles[i].flippedDiagonally ? 4 : 0);
+		}
+
+		if (count > 0) 
+		{
+			writer.WriteBytes(&fields[0], count * snapshotTileSize);
+		}
+	}
+
+	// Read tiles written by SaveTiles, returns false if not enough data is left.
+	static bool LoadTiles(SnapshotReader &reader, MapTile *tiles, int count) 
+	{
+		std::vector< int > fields(count * 3);
+		if (count > 0 && !reader.ReadBytes(&fields[0], count * snapshotTileSize)) 
+		{
+			return false;
+		}
+
+		for (int i = 0; i < count; i++) 
+		{
+			tiles[i].tilesetId = fields[i * 3];
+			tiles[i].id = (unsigned)fields[i * 3 + 1];
+			tiles[i].flippedHorizontally = (fields[i * 3 + 2] & 1) != 0;
+			tiles[i].flippedVertically = (fields[i * 3 + 2] & 2) != 0;
+			tiles[i].flippedDiagonally = (fields[i * 3 + 2] & 4) != 0;
+		}
+
+		return true;
+	}
+
 	Layer::Layer(const Map *_map) 
 		: map(_map)
 		, name() 
@@ -45,21 +93,87 @@ namespace Tmx
 		, opacity(1.0f)
 		, visible(true)
 		, properties()
+		, tile_map()
+		, payload()
+		, decoded(true)
+		, decode_mutex()
+		, chunked(false)
+		, origin_x(0)
+		, origin_y(0)
+		, chunks()
+		, chunk_grid()
+		, chunk_width(0)
+		, chunk_height(0)
+		, chunk_cols(0)
+		, chunk_rows(0)
 		, encoding(TMX_ENCODING_XML)
 		, compression(TMX_COMPRESSION_NONE)
+	{}
+
+	Layer::Layer(Layer &&_layer) 
+		: map(_layer.map)
+		, name(std::move(_layer.name)) 
+		, width(_layer.width) 
+		, height(_layer.height) 
+		, opacity(_layer.opacity)
+		, visible(_layer.visible)
+		, properties(std::move(_layer.properties))
+		, tile_map(std::move(_layer.tile_map))
+		, payload(std::move(_layer.payload))
+		, decoded(_layer.decoded.load(std::memory_order_acquire))
+		, decode_mutex()
+		, chunked(_layer.chunked)
+		, origin_x(_layer.origin_x)
+		, origin_y(_layer.origin_y)
+		, chunks(std::move(_layer.chunks))
+		, chunk_grid(std::move(_layer.chunk_grid))
+		, chunk_width(_layer.chunk_width)
+		, chunk_height(_layer.chunk_height)
+		, chunk_cols(_layer.chunk_cols)
+		, chunk_rows(_layer.chunk_rows)
+		, encoding(_layer.encoding)
+		, compression(_layer.compression)
 	{
-		// Set the map to null to specify that it is not yet allocated.
-		tile_map = NULL;
+		// Leave the other layer empty but usable.
+		_layer.width = 0;
+		_layer.height = 0;
+		_layer.decoded.store(true, std::memory_order_release);
 	}
 
-	Layer::~Layer() 
+	Layer &Layer::operator=(Layer &&_layer) 
 	{
-		// If the tile map is allocated, delete it from the memory.
-		if (tile_map)
+		if (this == &_layer) 
 		{
-			delete [] tile_map;
-			tile_map = NULL;
+			return *this;
 		}
+
+		map = _layer.map;
+		name = std::move(_layer.name);
+		width = _layer.width;
+		height = _layer.height;
+		opacity = _layer.opacity;
+		visible = _layer.visible;
+		properties = std::move(_layer.properties);
+		tile_map = std::move(_layer.tile_map);
+		payload = std::move(_layer.payload);
+		decoded.store(_layer.decoded.load(std::memory_order_acquire), std::memory_order_release);
+		chunked = _layer.chunked;
+		origin_x = _layer.origin_x;
+		origin_y = _layer.origin_y;
+		chunks = std::move(_layer.chunks);
+		chunk_grid = std::move(_layer.chunk_grid);
+		chunk_width = _layer.chunk_width;
+		chunk_height = _layer.chunk_height;
+		chunk_cols = _layer.chunk_cols;
+		chunk_rows = _layer.chunk_rows;
+		encoding = _layer.encoding;
+		compression = _layer.compression;
+
+		_layer.width = 0;
+		_layer.height = 0;
+		_layer.decoded.store(true, std::memory_order_release);
+
+		return *this;
 	}
 
 	void Layer::Parse(const TiXmlNode *layerNode) 
@@ -91,9 +205,6 @@ namespace Tmx
 			properties.Parse(propertiesNode);
 		}
 
-		// Allocate memory for reading the tiles.
-		tile_map = new MapTile[width * height];
-
 		const TiXmlNode *dataNode = layerNode->FirstChild("data");
 		const TiXmlElement *dataElem = dataNode->ToElement();
 
@@ -125,30 +236,291 @@ namespace Tmx
 				compression = TMX_COMPRESSION_ZLIB;
 			}
 		}
-		
+
+		// Layers of infinite maps store their tiles in chunks.
+		if (dataNode->FirstChild("chunk"))
+		{
+			chunked = true;
+			ParseChunks(dataNode);
+			return;
+		}
+
+		// Keep text data to be decoded on demand.
+		if (encoding != TMX_ENCODING_XML) 
+		{
+			const char *text = dataElem->GetText();
+			payload = text ? text : "";
+			decoded.store(false, std::memory_order_release);
+			return;
+		}
+
+		// Allocate memory for reading the tiles, cells missing from the data stay empty.
+		tile_map.assign(width * height, emptyTile);
+
+		ParseData(dataNode, tile_map.data(), width * height);
+	}
+
+	void Layer::Decode() const 
+	{
+		if (decoded.load(std::memory_order_acquire)) 
+		{
+			return;
+		}
+
+		std::lock_guard< std::mutex > lock(decode_mutex);
+
+		// Another thread may have decoded the tiles while this one waited.
+		if (decoded.load(std::memory_order_relaxed)) 
+		{
+			return;
+		}
+
+		tile_map.assign(width * height, emptyTile);
+		if (encoding == TMX_ENCODING_BASE64) 
+		{
+			ParseBase64(payload, tile_map.data(), width * height);
+		}
+		else 
+		{
+			ParseCSV(payload, tile_map.data(), width * height);
+		}
+
+		decoded.store(true, std::memory_order_release);
+	}
+
+	void Layer::Release() 
+	{
+		// Tiles decoded while parsing or loaded from a snapshot can not be
+		// decoded again.
+		if (chunked || payload.empty()) 
+		{
+			return;
+		}
+
+		std::lock_guard< std::mutex > lock(decode_mutex);
+
+		decoded.store(false, std::memory_order_release);
+		std::vector< MapTile >().swap(tile_map);
+	}
+
+	void Layer::ParseData(const TiXmlNode *dataNode, MapTile *tiles, int count) 
+	{
+		const char *text = dataNode->ToElement()->GetText();
+
 		// Decode.
 		switch (encoding) 
 		{
 		case TMX_ENCODING_XML:
-			ParseXML(dataNode);
+			ParseXML(dataNode, tiles, count);
 			break;
 
 		case TMX_ENCODING_BASE64:
-			ParseBase64(dataElem->GetText());
+			if (text) 
+			{
+				ParseBase64(text, tiles, count);
+			}
 			break;
 
 		case TMX_ENCODING_CSV:
-			ParseCSV(dataElem->GetText());
+			if (text) 
+			{
+				ParseCSV(text, tiles, count);
+			}
 			break;
 		}
 	}
 
-	void Layer::ParseXML(const TiXmlNode *dataNode) 
+	void Layer::ParseChunks(const TiXmlNode *dataNode) 
+	{
+		const TiXmlNode *chunkNode = dataNode->FirstChild("chunk");
+		while (chunkNode) 
+		{
+			const TiXmlElement *chunkElem = chunkNode->ToElement();
+
+			LayerChunk chunk;
+			chunk.x = 0;
+			chunk.y = 0;
+			chunk.width = 0;
+			chunk.height = 0;
+
+			chunkElem->Attribute("x", &chunk.x);
+			chunkElem->Attribute("y", &chunk.y);
+			chunkElem->Attribute("width", &chunk.width);
+			chunkElem->Attribute("height", &chunk.height);
+
+			if (chunk.width > 0 && chunk.height > 0) 
+			{
+				chunk.tiles.resize(chunk.width * chunk.height);
+				ParseData(chunkNode, &chunk.tiles[0], chunk.tiles.size());
+
+				// Only keep chunks that contain at least one tile.
+				for (unsigned int i = 0; i < chunk.tiles.size(); i++) 
+				{
+					if (chunk.tiles[i].tilesetId != -1) 
+					{
+						chunks.push_back(chunk);
+						break;
+					}
+				}
+			}
+
+			chunkNode = dataNode->IterateChildren("chunk", chunkNode);
+		}
+
+		int x, y, w, h;
+		if (GetChunkBounds(x, y, w, h)) 
+		{
+			SetBounds(x, y, w, h);
+		}
+		else 
+		{
+			SetBounds(0, 0, 0, 0);
+		}
+	}
+
+	bool Layer::GetChunkBounds(int &x, int &y, int &w, int &h) const 
+	{
+		if (chunks.empty()) 
+		{
+			return false;
+		}
+
+		int x0 = chunks[0].x;
+		int y0 = chunks[0].y;
+		int x1 = chunks[0].x + chunks[0].width;
+		int y1 = chunks[0].y + chunks[0].height;
+
+		for (unsigned int i = 1; i < chunks.size(); i++) 
+		{
+			const LayerChunk &chunk = chunks[i];
+			if (chunk.x < x0) x0 = chunk.x;
+			if (chunk.y < y0) y0 = chunk.y;
+			if (chunk.x + chunk.width > x1) x1 = chunk.x + chunk.width;
+			if (chunk.y + chunk.height > y1) y1 = chunk.y + chunk.height;
+		}
+
+		x = x0;
+		y = y0;
+		w = x1 - x0;
+		h = y1 - y0;
+
+		return true;
+	}
+
+	void Layer::SetBounds(int x, int y, int w, int h) 
+	{
+		origin_x = x;
+		origin_y = y;
+		width = w;
+		height = h;
+
+		chunk_grid.clear();
+		chunk_cols = 0;
+		chunk_rows = 0;
+
+		if (chunks.empty()) 
+		{
+			return;
+		}
+
+		// Tiled writes chunks of one size aligned to that size, which allows
+		// looking them up through a grid. Otherwise the chunks are searched.
+		chunk_width = chunks[0].width;
+		chunk_height = chunks[0].height;
+
+		for (unsigned int i = 0; i < chunks.size(); i++) 
+		{
+			const LayerChunk &chunk = chunks[i];
+			if (chunk.width != chunk_width || chunk.height != chunk_height ||
+				(chunk.x - origin_x) % chunk_width != 0 || (chunk.y - origin_y) % chunk_height != 0) 
+			{
+				return;
+			}
+		}
+
+		chunk_cols = (width + chunk_width - 1) / chunk_width;
+		chunk_rows = (height + chunk_height - 1) / chunk_height;
+		chunk_grid.assign(chunk_cols * chunk_rows, -1);
+
+		for (unsigned int i = 0; i < chunks.size(); i++) 
+		{
+			const int col = (chunks[i].x - origin_x) / chunk_width;
+			const int row = (chunks[i].y - origin_y) / chunk_height;
+			chunk_grid[row * chunk_cols + col] = i;
+		}
+	}
+
+	const MapTile &Layer::ChunkTileAt(int x, int y) const 
+	{
+		if (!chunk_grid.empty()) 
+		{
+			const int col = x / chunk_width;
+			const int row = y / chunk_height;
+			if (x < 0 || y < 0 || col >= chunk_cols || row >= chunk_rows) 
+			{
+				return emptyTile;
+			}
+
+			const int index = chunk_grid[row * chunk_cols + col];
+			if (index < 0) 
+			{
+				return emptyTile;
+			}
+
+			const LayerChunk &chunk = chunks[index];
+			return chunk.tiles[(y + origin_y - chunk.y) * chunk.width + (x + origin_x - chunk.x)];
+		}
+
+		const int mapX = x + origin_x;
+		const int mapY = y + origin_y;
+		for (unsigned int i = 0; i < chunks.size(); i++) 
+		{
+			const LayerChunk &chunk = chunks[i];
+			if (mapX >= chunk.x && mapX < chunk.x + chunk.width && 
+				mapY >= chunk.y && mapY < chunk.y + chunk.height) 
+			{
+				return chunk.tiles[(mapY - chunk.y) * chunk.width + (mapX - chunk.x)];
+			}
+		}
+
+		return emptyTile;
+	}
+
+	const MapTile *Layer::GetTileData() const 
+	{
+		if (chunked) 
+		{
+			return NULL;
+		}
+
+		if (!decoded.load(std::memory_order_acquire)) 
+		{
+			Decode();
+		}
+
+		return tile_map.empty() ? NULL : tile_map.data();
+	}
+
+	void Layer::SetTileId(int x, int y, unsigned id) 
+	{
+		const MapTile &tile = TileAt(x, y);
+
+		// The shared empty tile of missing chunks must not change.
+		if (&tile == &emptyTile) 
+		{
+			return;
+		}
+
+		const_cast< MapTile & >(tile).id = id;
+	}
+
+	void Layer::ParseXML(const TiXmlNode *dataNode, MapTile *tiles, int count) const 
 	{
 		const TiXmlNode *tileNode = dataNode->FirstChild("tile");
-		int tileCount = 0;
+		std::vector< unsigned > gids;
+		gids.reserve(count);
 
-		while (tileNode) 
+		while (tileNode && (int)gids.size() < count) 
 		{
 			const TiXmlElement *tileElem = tileNode->ToElement();
 			
@@ -158,120 +530,285 @@ namespace Tmx
 			const char* gidText = tileElem->Attribute("gid");
 
 			// Convert to an unsigned.
-			sscanf(gidText, "%u", &gid);
-
-			// Find the tileset index.
-			const int tilesetIndex = map->FindTilesetIndex(gid);
-			if (tilesetIndex != -1)
-			{
-				// If valid, set up the map tile with the tileset.
-				const Tmx::Tileset* tileset = map->GetTileset(tilesetIndex);
-				tile_map[tileCount] = MapTile(gid, tileset->GetFirstGid(), tilesetIndex);
-			}
-			else
+			if (gidText) 
 			{
-				// Otherwise, make it null.
-				tile_map[tileCount] = MapTile(gid, 0, -1);
+				sscanf(gidText, "%u", &gid);
 			}
+			gids.push_back(gid);
 
 			tileNode = dataNode->IterateChildren("tile", tileNode);
-			tileCount++;
 		}
+
+		// Convert the gids to map tiles.
+		ConvertGids(gids.data(), gids.size(), tiles);
 	}
 
-	void Layer::ParseBase64(const std::string &innerText) 
+	void Layer::ParseBase64(const std::string &innerText, MapTile *tiles, int count) const 
 	{
+		// Uncompressed data is decoded straight into the gids.
+		if (compression == TMX_COMPRESSION_NONE) 
+		{
+			ParseRawBase64(innerText, tiles, count);
+			return;
+		}
+
 		const std::string &text = Util::DecodeBase64(innerText);
 
 		// Temporary array of gids to be converted to map tiles.
 		unsigned *out = 0;
+		int outCount = count;
 
 		if (compression == TMX_COMPRESSION_ZLIB) 
 		{
 			// Use zlib to uncompress the layer into the temporary array of tiles.
-			uLongf outlen = width * height * 4;
+			uLongf outlen = count * 4;
 			out = (unsigned *)malloc(outlen);
-			uncompress(
+			if (uncompress(
 				(Bytef*)out, &outlen, 
-				(const Bytef*)text.c_str(), text.size());
-	
+				(const Bytef*)text.c_str(), text.size()) != Z_OK) 
+			{
+				outlen = 0;
+			}
+			outCount = outlen / 4;
 		} 
-		else if (compression == TMX_COMPRESSION_GZIP) 
+		else 
 		{
 			// Use the utility class for decompressing (which uses zlib)
 			out = (unsigned *)Util::DecompressGZIP(
 				text.c_str(), 
 				text.size(), 
-				width * height * 4);
+				count * 4);
+			if (!out) 
+			{
+				outCount = 0;
+			}
 		} 
-		else 
+
+		if (outCount > count) 
 		{
-			out = (unsigned *)malloc(text.size());
-		
-			// Copy every gid into the temporary array since
-			// the decoded string is an array of 32-bit integers.
-			memcpy(out, text.c_str(), text.size());
+			outCount = count;
 		}
 
 		// Convert the gids to map tiles.
-		for (int x = 0; x < width; x++)
+		ConvertGids(out, outCount, tiles);
+
+		// Free the temporary array from memory.
+		free(out);
+	}
+
+	void Layer::ParseRawBase64(const std::string &innerText, MapTile *tiles, int count) const 
+	{
+		// Like base64_decode, stop at the padding or at any character outside
+		// of the alphabet.
+		const char *text = innerText.c_str();
+		const int length = innerText.size();
+		int validLength = 0;
+		while (validLength < length && Util::IsBase64(text[validLength])) 
 		{
-			for (int y = 0; y < height; y++)
-			{
-				unsigned gid = out[y * width + x];
+			validLength++;
+		}
 
-				// Find the tileset index.
-				const int tilesetIndex = map->FindTilesetIndex(gid);
-				if (tilesetIndex != -1)
+		// Only decode what fits into the layer. The gids have room for the 
+		// bytes of a partial last group.
+		int numQuads = validLength / 4;
+		const int maxQuads = (count * 4 + 2) / 3;
+		if (numQuads > maxQuads) 
+		{
+			numQuads = maxQuads;
+		}
+
+		std::vector< unsigned > gids(count + 2);
+		unsigned char *bytes = (unsigned char *)gids.data();
+
+		// Every group of 4 characters gives 3 bytes, so large layers are 
+		// split into ranges of groups and decoded in parallel.
+		const int numTasks = Util::GetNumTasks(numQuads, 16384);
+		Util::ParallelFor(numTasks, [&](int task) 
+		{
+			const int first = (int)((long long)numQuads * task / numTasks);
+			const int last = (int)((long long)numQuads * (task + 1) / numTasks);
+			Util::DecodeBase64(text + first * 4, last - first, bytes + first * 3);
+		});
+
+		int numBytes = numQuads * 3;
+
+		// A partial last group of n characters gives n - 1 bytes.
+		const int rest = validLength - numQuads * 4;
+		if (rest >= 2 && rest < 4) 
+		{
+			char group[4] = { 'A', 'A', 'A', 'A' };
+			memcpy(group, text + numQuads * 4, rest);
+
+			unsigned char groupBytes[3];
+			Util::DecodeBase64(group, 1, groupBytes);
+			memcpy(bytes + numBytes, groupBytes, rest - 1);
+			numBytes += rest - 1;
+		}
+
+		// Convert the gids to map tiles.
+		const int outCount = numBytes / 4 < count ? numBytes / 4 : count;
+		ConvertGids(gids.data(), outCount, tiles);
+	}
+
+	void Layer::ParseCSV(const std::string &innerText, MapTile *tiles, int count) const 
+	{
+		// Every gid is a token of characters between commas, empty tokens 
+		// are skipped. A token starts at a character that is not a comma
+		// and follows a comma or the start of the text.
+		const char *text = innerText.c_str();
+		const int length = innerText.size();
+
+		// Split the text into ranges and count the tokens starting in each
+		// of them, this gives the index of the first gid of every range.
+		const int numTasks = Util::GetNumTasks(length, 65536);
+		std::vector< int > firstIndex(numTasks + 1, 0);
+
+		Util::ParallelFor(numTasks, [&](int task) 
+		{
+			const int first = (int)((long long)length * task / numTasks);
+			const int last = (int)((long long)length * (task + 1) / numTasks);
+
+			int numTokens = 0;
+			for (int i = first; i < last; i++) 
+			{
+				if (text[i] != ',' && (i == 0 || text[i - 1] == ',')) 
 				{
-					// If valid, set up the map tile with the tileset.
-					const Tmx::Tileset* tileset = map->GetTileset(tilesetIndex);
-					tile_map[y * width + x] = MapTile(gid, tileset->GetFirstGid(), tilesetIndex);
+					numTokens++;
 				}
-				else
+			}
+			firstIndex[task + 1] = numTokens;
+		});
+
+		for (int i = 0; i < numTasks; i++) 
+		{
+			firstIndex[i + 1] += firstIndex[i];
+		}
+
+		// Parse the tokens of every range into their place.
+		std::vector< unsigned > gids(count);
+		Util::ParallelFor(numTasks, [&](int task) 
+		{
+			const int first = (int)((long long)length * task / numTasks);
+			const int last = (int)((long long)length * (task + 1) / numTasks);
+
+			int index = firstIndex[task];
+			for (int i = first; i < last && index < count; i++) 
+			{
+				if (text[i] != ',' && (i == 0 || text[i - 1] == ',')) 
 				{
-					// Otherwise, make it null.
-					tile_map[y * width + x] = MapTile(gid, 0, -1);
+					gids[index++] = strtoul(text + i, NULL, 10);
 				}
 			}
+		});
+
+		// Convert the gids to map tiles.
+		const int outCount = firstIndex[numTasks] < count ? firstIndex[numTasks] : count;
+		ConvertGids(gids.data(), outCount, tiles);
+	}
+
+	void Layer::ConvertGids(const unsigned *gids, int count, MapTile *tiles) const 
+	{
+		std::vector< int > firstGids(map->GetNumTilesets());
+		for (int i = 0; i < map->GetNumTilesets(); i++) 
+		{
+			firstGids[i] = map->GetTileset(i)->GetFirstGid();
 		}
 
-		// Free the temporary array from memory.
-		free(out);
+		// Large layers are converted in parallel ranges.
+		const int numTasks = Util::GetNumTasks(count, 65536);
+		Util::ParallelFor(numTasks, [&](int task) 
+		{
+			const int first = (int)((long long)count * task / numTasks);
+			const int last = (int)((long long)count * (task + 1) / numTasks);
+			Util::ConvertGids(gids + first, last - first, firstGids, tiles + first);
+		});
+	}
+
+	void Layer::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteString(name);
+		writer.WriteInt(width);
+		writer.WriteInt(height);
+		writer.WriteDouble(opacity);
+		writer.WriteInt(visible);
+		properties.Save(writer);
+		writer.WriteInt(encoding);
+		writer.WriteInt(compression);
+		writer.WriteInt(origin_x);
+		writer.WriteInt(origin_y);
+
+		// The tiles are stored decoded so loading is a plain copy.
+		writer.WriteInt(chunked);
+		if (!chunked) 
+		{
+			Decode();
+			SaveTiles(writer, tile_map.data(), width * height);
+			return;
+		}
+
+		writer.WriteInt(chunks.size());
+		for (unsigned int i = 0; i < chunks.size(); i++) 
+		{
+			const LayerChunk &chunk = chunks[i];
+			writer.WriteInt(chunk.x);
+			writer.WriteInt(chunk.y);
+			writer.WriteInt(chunk.width);
+			writer.WriteInt(chunk.height);
+			SaveTiles(writer, &chunk.tiles[0], chunk.tiles.size());
+		}
 	}
 
-	void Layer::ParseCSV(const std::string &innerText) 
+	void Layer::Load(SnapshotReader &reader) 
 	{
-		// Duplicate the string for use with C stdio.
-		char *csv = strdup(innerText.c_str());
-		
-		// Iterate through every token of ';' in the CSV string.
-		char *pch = strtok(csv, ",");
-		int tileCount = 0;
-		
-		while (pch) 
-		{
-			unsigned gid;
-			sscanf(pch, "%u", &gid);
-
-			// Find the tileset index.
-			const int tilesetIndex = map->FindTilesetIndex(gid);
-			if (tilesetIndex != -1)
+		name = reader.ReadString();
+		width = reader.ReadInt();
+		height = reader.ReadInt();
+		opacity = (float)reader.ReadDouble();
+		visible = reader.ReadInt() != 0;
+		properties.Load(reader);
+		encoding = (LayerEncodingType)reader.ReadInt();
+		compression = (LayerCompressionType)reader.ReadInt();
+		int originX = reader.ReadInt();
+		int originY = reader.ReadInt();
+
+		chunked = reader.ReadInt() != 0;
+		if (!chunked) 
+		{
+			if (width < 0 || height < 0 || (height > 0 && width > INT_MAX / snapshotTileSize / height)) 
+			{
+				width = 0;
+				height = 0;
+			}
+
+			tile_map.resize(width * height);
+			LoadTiles(reader, tile_map.data(), width * height);
+			return;
+		}
+
+		int numChunks = reader.ReadCount(16);
+		for (int i = 0; i < numChunks && !reader.HasError(); i++) 
+		{
+			LayerChunk chunk;
+			chunk.x = reader.ReadInt();
+			chunk.y = reader.ReadInt();
+			chunk.width = reader.ReadInt();
+			chunk.height = reader.ReadInt();
+
+			const int numTiles = chunk.width * chunk.height;
+			if (chunk.width <= 0 || chunk.height <= 0 || numTiles / chunk.width != chunk.height || numTiles > INT_MAX / snapshotTileSize) 
 			{
-				// If valid, set up the map tile with the tileset.
-				const Tmx::Tileset* tileset = map->GetTileset(tilesetIndex);
-				tile_map[tileCount] = MapTile(gid, tileset->GetFirstGid(), tilesetIndex);
+				break;
 			}
-			else
+
+			chunk.tiles.resize(numTiles);
+			if (!LoadTiles(reader, &chunk.tiles[0], numTiles)) 
 			{
-				// Otherwise, make it null.
-				tile_map[tileCount] = MapTile(gid, 0, -1);
+				break;
 			}
 
-			pch = strtok(NULL, ",");
-			tileCount++;
+			chunks.push_back(chunk);
 		}
 
-		free(csv);
+		SetBounds(originX, originY, width, height);
 	}
 };
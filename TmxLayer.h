@@ -27,7 +27,10 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "TmxPropertySet.h"
 #include "TmxMapTile.h"
@@ -36,6 +39,8 @@ class TiXmlNode;
 
 namespace Tmx 
 {
+	class SnapshotReader;
+	class SnapshotWriter;
 	class Map;
 
 	//-------------------------------------------------------------------------
@@ -58,6 +63,23 @@ namespace Tmx
 		TMX_COMPRESSION_GZIP
 	};
 
+	//-------------------------------------------------------------------------
+	// A rectangular part of an infinite map layer.
+	//-------------------------------------------------------------------------
+	struct LayerChunk
+	{
+		// Position of the chunk, in tiles.
+		int x;
+		int y;
+
+		// Size of the chunk, in tiles.
+		int width;
+		int height;
+
+		// The tiles of the chunk, row by row.
+		std::vector< Tmx::MapTile > tiles;
+	};
+
 	//-------------------------------------------------------------------------
 	// Used for storing information about the tile ids for every layer.
 	// This class also have a property set.
@@ -67,14 +89,42 @@ namespace Tmx
 	private:
 		// Prevent copy constructor.
 		Layer(const Layer &_layer);
+		Layer &operator=(const Layer &_layer);
 
 	public:
 		Layer(const Tmx::Map *_map);
-		~Layer();
+
+		// Layers are moved rather than copied, the tiles are not duplicated.
+		// A layer that is being decoded can not be moved.
+		Layer(Layer &&_layer);
+		Layer &operator=(Layer &&_layer);
 
 		// Parse a layer node.
+		// CSV and base64 data is kept encoded and only decoded on the first
+		// access to a tile or a call to Decode(). XML data and the chunks of
+		// infinite maps are decoded right away.
 		void Parse(const TiXmlNode *layerNode);
 
+		// Write the layer into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the layer back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
+
+		// Decode the tiles if not done yet. Safe to call from several threads,
+		// the data is decoded once. Large CSV and uncompressed base64 layers
+		// are decoded by several threads.
+		void Decode() const;
+
+		// Free the decoded tiles, they are decoded again on the next access.
+		// Changes made by SetTileId are lost. Layers that were decoded while
+		// parsing or loaded from a snapshot keep their tiles. Must not be called while other threads
+		// access the layer.
+		void Release();
+
+		// Get whether the tiles are currently decoded.
+		bool IsDecoded() const { return decoded.load(std::memory_order_acquire); }
+
 		// Get the name of the layer.
 		const std::string &GetName() const { return name; }
 
@@ -91,27 +141,59 @@ namespace Tmx
 		const Tmx::PropertySet &GetProperties() const { return properties; }
 
 		// Pick a specific tile from the list.
-		unsigned GetTileId(int x, int y) const { return tile_map[y * width + x].id; }
+		unsigned GetTileId(int x, int y) const { return TileAt(x, y).id; }
 
 		// Get the tileset index for a tileset from the list.
-		int GetTileTilesetIndex(int x, int y) const { return tile_map[y * width + x].tilesetId; }
+		int GetTileTilesetIndex(int x, int y) const { return TileAt(x, y).tilesetId; }
 
 		// Set a specific tile in the list.
-		unsigned SetTileId(int x, int y, unsigned id) { tile_map[y * width + x].id = id; }
+		// Tiles outside of the chunks of an infinite layer can not be set.
+		void SetTileId(int x, int y, unsigned id);
+
 		// Get whether a tile is flipped horizontally.
 		bool IsTileFlippedHorizontally(int x, int y) const 
-		{ return tile_map[y * width + x].flippedHorizontally; }
+		{ return TileAt(x, y).flippedHorizontally; }
 
 		// Get whether a tile is flipped vertically.
 		bool IsTileFlippedVertically(int x, int y) const 
-		{ return tile_map[y * width + x].flippedVertically; }
+		{ return TileAt(x, y).flippedVertically; }
 
 		// Get whether a tile is flipped diagonally.
 		bool IsTileFlippedDiagonally(int x, int y) const
-		{ return tile_map[y * width + x].flippedDiagonally; }
+		{ return TileAt(x, y).flippedDiagonally; }
 
 		// Get a tile specific to the map.
-		const Tmx::MapTile& GetTile(int x, int y) const { return tile_map[y * width + x]; }
+		const Tmx::MapTile& GetTile(int x, int y) const { return TileAt(x, y); }
+
+		// Get all tiles of a layer that is not chunked, row after row, 
+		// NULL for chunked or empty layers.
+		const Tmx::MapTile *GetTileData() const;
+
+		// Get whether the layer is stored as chunks of an infinite map.
+		bool IsChunked() const { return chunked; }
+
+		// Get the position of the tile at (0, 0) in the map, in tiles.
+		// This is only non-zero for infinite maps.
+		int GetOriginX() const { return origin_x; }
+		int GetOriginY() const { return origin_y; }
+
+		// Get the amount of non-empty chunks of an infinite layer.
+		int GetNumChunks() const { return chunks.size(); }
+
+		// Get a chunk of an infinite layer, positioned in map tiles.
+		const Tmx::LayerChunk &GetChunk(int index) const { return chunks.at(index); }
+
+		// Get the bounding box of all non-empty chunks, in tiles.
+		// Returns false if the layer has no chunks.
+		bool GetChunkBounds(int &x, int &y, int &w, int &h) const;
+
+		// Set the area of the map covered by an infinite layer.
+		// Used by the map to give all chunked layers the same bounds.
+		void SetBounds(int x, int y, int w, int h);
+
+		// Set the map the layer belongs to.
+		// Used by the map to keep its layers pointing at it after a move.
+		void SetMap(const Tmx::Map *_map) { map = _map; }
 
 		// Get the type of encoding that was used for parsing the layer data.
 		// See: LayerEncodingType
@@ -122,9 +204,21 @@ namespace Tmx
 		Tmx::LayerCompressionType GetCompression() const { return compression; }
 
 	private:
-		void ParseXML(const TiXmlNode *dataNode);
-		void ParseBase64(const std::string &innerText);
-		void ParseCSV(const std::string &innerText);
+		void ParseXML(const TiXmlNode *dataNode, Tmx::MapTile *tiles, int count) const;
+		void ParseBase64(const std::string &innerText, Tmx::MapTile *tiles, int count) const;
+		void ParseRawBase64(const std::string &innerText, Tmx::MapTile *tiles, int count) const;
+		void ParseCSV(const std::string &innerText, Tmx::MapTile *tiles, int count) const;
+		void ConvertGids(const unsigned *gids, int count, Tmx::MapTile *tiles) const;
+		void ParseData(const TiXmlNode *dataNode, Tmx::MapTile *tiles, int count);
+		void ParseChunks(const TiXmlNode *dataNode);
+
+		// Get a tile, either from the dense tile map or from the chunks.
+		const Tmx::MapTile &TileAt(int x, int y) const 
+		{
+			if (!decoded.load(std::memory_order_acquire)) Decode();
+			return chunked ? ChunkTileAt(x, y) : tile_map[y * width + x];
+		}
+		const Tmx::MapTile &ChunkTileAt(int x, int y) const;
 
 		const Tmx::Map *map;
 
@@ -138,7 +232,26 @@ namespace Tmx
 
 		Tmx::PropertySet properties;
 
-		Tmx::MapTile *tile_map;
+		// Decoded tiles of a layer that is not chunked, allocated on demand.
+		mutable std::vector< Tmx::MapTile > tile_map;
+
+		// Encoded data kept for decoding on demand.
+		std::string payload;
+		mutable std::atomic< bool > decoded;
+		mutable std::mutex decode_mutex;
+
+		bool chunked;
+		int origin_x;
+		int origin_y;
+
+		// Chunks of an infinite layer, and a grid of chunk indices
+		// covering the bounds of the layer with -1 for missing chunks.
+		std::vector< Tmx::LayerChunk > chunks;
+		std::vector< int > chunk_grid;
+		int chunk_width;
+		int chunk_height;
+		int chunk_cols;
+		int chunk_rows;
 
 		Tmx::LayerEncodingType encoding;
 		Tmx::LayerCompressionType compression;
@@ -26,12 +26,18 @@
 // Author: Tamir Atias
 //-----------------------------------------------------------------------------
 #include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "tinyxml.h"
 #include "TmxMap.h"
 #include "TmxTileset.h"
 #include "TmxLayer.h"
 #include "TmxObjectGroup.h"
+#include "TmxMapTile.h"
+#include "TmxSnapshot.h"
 
 #ifdef USE_SDL2_LOAD
 #include <SDL.h>
@@ -40,6 +46,10 @@
 using std::vector;
 using std::string;
 
+// Identifies snapshot files and the layout of the data in them.
+static const int snapshotMagic = 0x534d5854; // "TXMS"
+static const int snapshotVersion = 3;
+
 namespace Tmx 
 {
 	Map::Map() 
@@ -47,6 +57,7 @@ namespace Tmx
 		, file_path()
 		, version(0.0)
 		, orientation(TMX_MO_ORTHOGONAL)
+		, infinite(false)
 		, width(0)
 		, height(0)
 		, tile_width(0)
@@ -54,51 +65,54 @@ namespace Tmx
 		, layers()
 		, object_groups()
 		, tilesets() 
+		, layer_names()
+		, object_group_names()
+		, tileset_names()
 		, has_error(false)
 		, error_code(0)
 		, error_text()
 	{}
 
-	Map::~Map() 
+	Map::Map(Map &&_map) 
+		: Map()
 	{
-		// Iterate through all of the object groups and delete each of them.
-		vector< ObjectGroup* >::iterator ogIter;
-		for (ogIter = object_groups.begin(); ogIter != object_groups.end(); ++ogIter) 
-		{
-			ObjectGroup *objectGroup = (*ogIter);
-			
-			if (objectGroup)
-			{
-				delete objectGroup;
-				objectGroup = NULL;
-			}
-		}
+		*this = std::move(_map);
+	}
 
-		// Iterate through all of the layers and delete each of them.
-		vector< Layer* >::iterator lIter;
-		for (lIter = layers.begin(); lIter != layers.end(); ++lIter) 
+	Map &Map::operator=(Map &&_map) 
+	{
+		if (this == &_map) 
 		{
-			Layer *layer = (*lIter);
-
-			if (layer) 
-			{
-				delete layer;
-				layer = NULL;
-			}
+			return *this;
 		}
 
-		// Iterate through all of the tilesets and delete each of them.
-		vector< Tileset* >::iterator tsIter;
-		for (tsIter = tilesets.begin(); tsIter != tilesets.end(); ++tsIter) 
+		file_name = std::move(_map.file_name);
+		file_path = std::move(_map.file_path);
+		version = _map.version;
+		orientation = _map.orientation;
+		infinite = _map.infinite;
+		width = _map.width;
+		height = _map.height;
+		tile_width = _map.tile_width;
+		tile_height = _map.tile_height;
+		layers = std::move(_map.layers);
+		object_groups = std::move(_map.object_groups);
+		tilesets = std::move(_map.tilesets);
+		layer_names = std::move(_map.layer_names);
+		object_group_names = std::move(_map.object_group_names);
+		tileset_names = std::move(_map.tileset_names);
+		has_error = _map.has_error;
+		error_code = _map.error_code;
+		error_text = std::move(_map.error_text);
+		properties = std::move(_map.properties);
+
+		// The layers look up tilesets through the map they belong to.
+		for (unsigned int i = 0; i < layers.size(); i++) 
 		{
-			Tileset *tileset = (*tsIter);
-			
-			if (tileset) 
-			{
-				delete tileset;
-				tileset = NULL;
-			}
+			layers[i].SetMap(this);
 		}
+
+		return *this;
 	}
 
 	void Map::ParseFile(const string &fileName) 
@@ -176,6 +190,17 @@ namespace Tmx
 		ParseText(text);		
 	}
 
+	void Map::ParseText(const string &text, const string &filePath) 
+	{
+		file_path = filePath;
+		if (!file_path.empty() && file_path[file_path.size() - 1] != '/') 
+		{
+			file_path += '/';
+		}
+
+		ParseText(text);
+	}
+
 	void Map::ParseText(const string &text) 
 	{
 		// Create a tiny xml document and use it to parse the text.
@@ -192,6 +217,14 @@ namespace Tmx
 		}
 
 		TiXmlNode *mapNode = doc.FirstChild("map");
+		if (!mapNode) 
+		{
+			has_error = true;
+			error_code = TMX_PARSING_ERROR;
+			error_text = "No map element.";
+			return;
+		}
+
 		TiXmlElement* mapElem = mapNode->ToElement();
 
 		// Read the map attributes.
@@ -201,6 +234,10 @@ namespace Tmx
 		mapElem->Attribute("tilewidth", &tile_width);
 		mapElem->Attribute("tileheight", &tile_height);
 
+		int infiniteAttr = 0;
+		mapElem->Attribute("infinite", &infiniteAttr);
+		infinite = infiniteAttr != 0;
+
 		// Read the orientation
 		std::string orientationStr = mapElem->Attribute("orientation");
 
@@ -224,12 +261,9 @@ namespace Tmx
 		const TiXmlNode *tilesetNode = mapNode->FirstChild("tileset");
 		while (tilesetNode) 
 		{
-			// Allocate a new tileset and parse it.
-			Tileset *tileset = new Tileset();
-			tileset->Parse(tilesetNode->ToElement());
-
-			// Add the tileset to the list.
-			tilesets.push_back(tileset);
+			// Add a new tileset to the list and parse it.
+			tilesets.emplace_back();
+			tilesets.back().Parse(tilesetNode->ToElement(), file_path);
 
 			tilesetNode = mapNode->IterateChildren("tileset", tilesetNode);
 		}
@@ -238,29 +272,199 @@ namespace Tmx
 		TiXmlNode *layerNode = mapNode->FirstChild("layer");
 		while (layerNode) 
 		{
-			// Allocate a new layer and parse it.
-			Layer *layer = new Layer(this);
-			layer->Parse(layerNode);
-
-			// Add the layer to the list.
-			layers.push_back(layer);
+			// Add a new layer to the list and parse it.
+			layers.emplace_back(this);
+			layers.back().Parse(layerNode);
 
 			layerNode = mapNode->IterateChildren("layer", layerNode);
 		}
 
+		// Crop all chunked layers to the area covered by any of them.
+		bool hasChunks = false;
+		int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+		for (unsigned int i = 0; i < layers.size(); i++) 
+		{
+			int x, y, w, h;
+			if (layers[i].IsChunked() && layers[i].GetChunkBounds(x, y, w, h)) 
+			{
+				if (!hasChunks || x < x0) x0 = x;
+				if (!hasChunks || y < y0) y0 = y;
+				if (!hasChunks || x + w > x1) x1 = x + w;
+				if (!hasChunks || y + h > y1) y1 = y + h;
+				hasChunks = true;
+			}
+		}
+
+		if (hasChunks) 
+		{
+			width = x1 - x0;
+			height = y1 - y0;
+
+			for (unsigned int i = 0; i < layers.size(); i++) 
+			{
+				if (layers[i].IsChunked()) 
+				{
+					layers[i].SetBounds(x0, y0, width, height);
+				}
+			}
+		}
+
 		// Iterate through all of the objectgroup elements.
 		TiXmlNode *objectGroupNode = mapNode->FirstChild("objectgroup");
 		while (objectGroupNode) 
 		{
-			// Allocate a new object group and parse it.
-			ObjectGroup *objectGroup = new ObjectGroup();
-			objectGroup->Parse(objectGroupNode);
-		
-			// Add the object group to the list.
-			object_groups.push_back(objectGroup);
+			// Add a new object group to the list and parse it.
+			object_groups.emplace_back();
+			object_groups.back().Parse(objectGroupNode);
 
 			objectGroupNode = mapNode->IterateChildren("objectgroup", objectGroupNode);
 		}
+
+		BuildIndexes();
+	}
+
+	bool Map::SaveSnapshot(const string &fileName) const 
+	{
+		SnapshotWriter writer;
+
+		writer.WriteInt(snapshotMagic);
+		writer.WriteInt(snapshotVersion);
+		writer.WriteInt(sizeof(MapTile));
+
+		writer.WriteString(file_name);
+		writer.WriteString(file_path);
+		writer.WriteDouble(version);
+		writer.WriteInt(orientation);
+		writer.WriteInt(infinite);
+		writer.WriteInt(width);
+		writer.WriteInt(height);
+		writer.WriteInt(tile_width);
+		writer.WriteInt(tile_height);
+		properties.Save(writer);
+
+		writer.WriteInt(tilesets.size());
+		for (unsigned int i = 0; i < tilesets.size(); i++) 
+		{
+			tilesets[i].Save(writer);
+		}
+
+		writer.WriteInt(layers.size());
+		for (unsigned int i = 0; i < layers.size(); i++) 
+		{
+			layers[i].Save(writer);
+		}
+
+		writer.WriteInt(object_groups.size());
+		for (unsigned int i = 0; i < object_groups.size(); i++) 
+		{
+			object_groups[i].Save(writer);
+		}
+
+		FILE *file = fopen(fileName.c_str(), "wb");
+		if (!file) 
+		{
+			return false;
+		}
+
+		const vector< char > &data = writer.GetData();
+		bool ok = fwrite(&data[0], 1, data.size(), file) == data.size();
+		if (fclose(file) != 0) 
+		{
+			ok = false;
+		}
+
+		return ok;
+	}
+
+	void Map::LoadSnapshot(const string &fileName) 
+	{
+		int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0) 
+		{
+			has_error = true;
+			error_code = TMX_COULDNT_OPEN;
+			error_text = "Could not open the file.";
+			return;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > 0x7fffffff) 
+		{
+			close(fd);
+			has_error = true;
+			error_code = TMX_INVALID_FILE_SIZE;
+			error_text = "The size of the file is invalid.";
+			return;
+		}
+
+		void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (data == MAP_FAILED) 
+		{
+			has_error = true;
+			error_code = TMX_COULDNT_OPEN;
+			error_text = "Could not map the file.";
+			return;
+		}
+
+		SnapshotReader reader((const char *)data, st.st_size);
+
+		if (reader.ReadInt() != snapshotMagic || 
+			reader.ReadInt() != snapshotVersion || 
+			reader.ReadInt() != (int)sizeof(MapTile)) 
+		{
+			munmap(data, st.st_size);
+			has_error = true;
+			error_code = TMX_INVALID_SNAPSHOT;
+			error_text = "The file is not a snapshot of this version.";
+			return;
+		}
+
+		file_name = reader.ReadString();
+		file_path = reader.ReadString();
+		version = reader.ReadDouble();
+		orientation = (MapOrientation)reader.ReadInt();
+		infinite = reader.ReadInt() != 0;
+		width = reader.ReadInt();
+		height = reader.ReadInt();
+		tile_width = reader.ReadInt();
+		tile_height = reader.ReadInt();
+		properties.Load(reader);
+
+		int numTilesets = reader.ReadCount(4);
+		tilesets.reserve(numTilesets);
+		for (int i = 0; i < numTilesets && !reader.HasError(); i++) 
+		{
+			tilesets.emplace_back();
+			tilesets.back().Load(reader);
+		}
+
+		int numLayers = reader.ReadCount(4);
+		layers.reserve(numLayers);
+		for (int i = 0; i < numLayers && !reader.HasError(); i++) 
+		{
+			layers.emplace_back(this);
+			layers.back().Load(reader);
+		}
+
+		int numObjectGroups = reader.ReadCount(4);
+		object_groups.reserve(numObjectGroups);
+		for (int i = 0; i < numObjectGroups && !reader.HasError(); i++) 
+		{
+			object_groups.emplace_back();
+			object_groups.back().Load(reader);
+		}
+
+		munmap(data, st.st_size);
+		BuildIndexes();
+
+		if (reader.HasError()) 
+		{
+			has_error = true;
+			error_code = TMX_INVALID_SNAPSHOT;
+			error_text = "The snapshot is truncated or corrupt.";
+		}
 	}
 
 	int Map::FindTilesetIndex(int gid) const
@@ -271,7 +475,7 @@ namespace Tmx
 		for (int i = tilesets.size() - 1; i > -1; --i) 
 		{
 			// If the gid beyond the tileset gid return its index.
-			if (gid >= tilesets[i]->GetFirstGid()) 
+			if (gid >= tilesets[i].GetFirstGid()) 
 			{
 				return i;
 			}
@@ -285,12 +489,70 @@ namespace Tmx
 		for (int i = tilesets.size() - 1; i > -1; --i) 
 		{
 			// If the gid beyond the tileset gid return it.
-			if (gid >= tilesets[i]->GetFirstGid()) 
+			if (gid >= tilesets[i].GetFirstGid()) 
 			{
-				return tilesets[i];
+				return &tilesets[i];
 			}
 		}
 		
 		return NULL;
 	}
+
+	int Map::FindTilesetIndex(const string &name) const 
+	{
+		std::unordered_map< string, int >::const_iterator iter = tileset_names.find(name);
+		return iter != tileset_names.end() ? iter->second : -1;
+	}
+
+	const Tileset *Map::FindTileset(const string &name) const 
+	{
+		const int index = FindTilesetIndex(name);
+		return index >= 0 ? &tilesets[index] : NULL;
+	}
+
+	int Map::FindLayerIndex(const string &name) const 
+	{
+		std::unordered_map< string, int >::const_iterator iter = layer_names.find(name);
+		return iter != layer_names.end() ? iter->second : -1;
+	}
+
+	const Layer *Map::FindLayer(const string &name) const 
+	{
+		const int index = FindLayerIndex(name);
+		return index >= 0 ? &layers[index] : NULL;
+	}
+
+	int Map::FindObjectGroupIndex(const string &name) const 
+	{
+		std::unordered_map< string, int >::const_iterator iter = object_group_names.find(name);
+		return iter != object_group_names.end() ? iter->second : -1;
+	}
+
+	const ObjectGroup *Map::FindObjectGroup(const string &name) const 
+	{
+		const int index = FindObjectGroupIndex(name);
+		return index >= 0 ? &object_groups[index] : NULL;
+	}
+
+	void Map::BuildIndexes() 
+	{
+		// emplace keeps the first entry of a name.
+		tileset_names.clear();
+		for (unsigned int i = 0; i < tilesets.size(); i++) 
+		{
+			tileset_names.emplace(tilesets[i].GetName(), i);
+		}
+
+		layer_names.clear();
+		for (unsigned int i = 0; i < layers.size(); i++) 
+		{
+			layer_names.emplace(layers[i].GetName(), i);
+		}
+
+		object_group_names.clear();
+		for (unsigned int i = 0; i < object_groups.size(); i++) 
+		{
+			object_group_names.emplace(object_groups[i].GetName(), i);
+		}
+	}
 };
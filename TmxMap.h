@@ -29,15 +29,15 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include "TmxPropertySet.h"
+#include "TmxTileset.h"
+#include "TmxLayer.h"
+#include "TmxObjectGroup.h"
 
 namespace Tmx 
 {
-	class Layer;
-	class ObjectGroup;
-	class Tileset;
-
 	//-------------------------------------------------------------------------
 	// Error in handling of the Map class.
 	//-------------------------------------------------------------------------
@@ -51,7 +51,10 @@ namespace Tmx
 		TMX_PARSING_ERROR = 0x02,
 		
 		// The size of the file is invalid.
-		TMX_INVALID_FILE_SIZE = 0x04
+		TMX_INVALID_FILE_SIZE = 0x04,
+
+		// A snapshot is truncated, corrupt or from another version.
+		TMX_INVALID_SNAPSHOT = 0x08
 	};
 
 	//-------------------------------------------------------------------------
@@ -76,10 +79,15 @@ namespace Tmx
 	private:
 		// Prevent copy constructor.
 		Map(const Map &_map);
+		Map &operator=(const Map &_map);
 
 	public:
 		Map();
-		~Map();
+
+		// Maps can be moved, for example between pipeline stages or into
+		// containers. The layers are kept pointing at the new map.
+		Map(Map &&_map);
+		Map &operator=(Map &&_map);
 
 		// Read a file and parse it.
 		// Note: use '/' instead of '\\' as it is using '/' to find the path.
@@ -88,6 +96,20 @@ namespace Tmx
 		// Parse text containing TMX formatted XML.
 		void ParseText(const std::string &text);
 
+		// Parse text containing TMX formatted XML, with external tilesets
+		// and images relative to the directory filePath.
+		void ParseText(const std::string &text, const std::string &filePath);
+
+		// Write the parsed map into a binary snapshot file.
+		// The snapshot holds everything needed to recreate the map with the
+		// tiles already decoded, in native byte order.
+		// Returns false if the file could not be written.
+		bool SaveSnapshot(const std::string &fileName) const;
+
+		// Load a map written by SaveSnapshot instead of parsing a TMX file.
+		// The file is mapped into memory and the tiles are copied directly.
+		void LoadSnapshot(const std::string &fileName);
+
 		// Get the filename used to read the map.
 		const std::string &GetFilename() { return file_name; }
 
@@ -100,6 +122,11 @@ namespace Tmx
 		// Get the orientation of the map.
 		Tmx::MapOrientation GetOrientation() const { return orientation; }
 
+		// Get whether the map is infinite.
+		// The layers of an infinite map are cropped to the area covered by
+		// their chunks, which also becomes the size of the map.
+		bool IsInfinite() const { return infinite; }
+
 		// Get the width of the map, in tiles.
 		int GetWidth() const { return width; }
 
@@ -113,22 +140,22 @@ namespace Tmx
 		int GetTileHeight() const { return tile_height; }
 
 		// Get the layer at a certain index.
-		const Tmx::Layer *GetLayer(int index) const { return layers.at(index); }
+		const Tmx::Layer *GetLayer(int index) const { return &layers.at(index); }
 
 		// Get the amount of layers.
 		int GetNumLayers() const { return layers.size(); }
 
 		// Get the whole layers collection.
-		const std::vector< Tmx::Layer* > &GetLayers() const { return layers; }
+		const std::vector< Tmx::Layer > &GetLayers() const { return layers; }
 
 		// Get the object group at a certain index.
-		const Tmx::ObjectGroup *GetObjectGroup(int index) const { return object_groups.at(index); }
+		const Tmx::ObjectGroup *GetObjectGroup(int index) const { return &object_groups.at(index); }
 
 		// Get the amount of object groups.
 		int GetNumObjectGroups() const { return object_groups.size(); }
 
 		// Get the whole object group collection.
-		const std::vector< Tmx::ObjectGroup* > &GetObjectGroups() const { return object_groups; }
+		const std::vector< Tmx::ObjectGroup > &GetObjectGroups() const { return object_groups; }
 
 		// Find the tileset index for a tileset using a tile gid.
 		int FindTilesetIndex(int gid) const;
@@ -136,14 +163,32 @@ namespace Tmx
 		// Find a tileset for a specific gid.
 		const Tmx::Tileset *FindTileset(int gid) const;
 
+		// Find the index of the first tileset with a name, -1 if none.
+		int FindTilesetIndex(const std::string &name) const;
+
+		// Find the first tileset with a name, NULL if none.
+		const Tmx::Tileset *FindTileset(const std::string &name) const;
+
+		// Find the index of the first layer with a name, -1 if none.
+		int FindLayerIndex(const std::string &name) const;
+
+		// Find the first layer with a name, NULL if none.
+		const Tmx::Layer *FindLayer(const std::string &name) const;
+
+		// Find the index of the first object group with a name, -1 if none.
+		int FindObjectGroupIndex(const std::string &name) const;
+
+		// Find the first object group with a name, NULL if none.
+		const Tmx::ObjectGroup *FindObjectGroup(const std::string &name) const;
+
 		// Get a tileset by an index.
-		const Tmx::Tileset *GetTileset(int index) const { return tilesets.at(index); }
+		const Tmx::Tileset *GetTileset(int index) const { return &tilesets.at(index); }
 
 		// Get the amount of tilesets.
 		int GetNumTilesets() const { return tilesets.size(); }
 
 		// Get the collection of tilesets.
-		const std::vector< Tmx::Tileset* > &GetTilesets() const { return tilesets; }
+		const std::vector< Tmx::Tileset > &GetTilesets() const { return tilesets; }
 
 		// Get whether there was an error or not.
 		bool HasError() const { return has_error; }
@@ -155,23 +200,33 @@ namespace Tmx
 		unsigned char GetErrorCode() const { return error_code; }
 
 		// Get the property set.
-		const Tmx::PropertySet &GetProperties() { return properties; }
+		const Tmx::PropertySet &GetProperties() const { return properties; }
 
 	private:
+		// Build the name indexes once all tilesets, layers and object 
+		// groups are read.
+		void BuildIndexes();
+
 		std::string file_name;
 		std::string file_path;
 
 		double version;
 		Tmx::MapOrientation orientation;
+		bool infinite;
 
 		int width;
 		int height;
 		int tile_width;
 		int tile_height;
 
-		std::vector< Tmx::Layer* > layers;
-		std::vector< Tmx::ObjectGroup* > object_groups;
-		std::vector< Tmx::Tileset* > tilesets;
+		std::vector< Tmx::Layer > layers;
+		std::vector< Tmx::ObjectGroup > object_groups;
+		std::vector< Tmx::Tileset > tilesets;
+
+		// Indexes into the vectors above by name, first one wins.
+		std::unordered_map< std::string, int > layer_names;
+		std::unordered_map< std::string, int > object_group_names;
+		std::unordered_map< std::string, int > tileset_names;
 
 		bool has_error;
 		unsigned char error_code;
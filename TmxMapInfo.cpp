@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "tinyxml.h"
+#include "TmxMapInfo.h"
+
+using std::string;
+
+namespace Tmx 
+{
+	MapInfo::MapInfo() 
+		: version(0.0)
+		, orientation(TMX_MO_ORTHOGONAL)
+		, infinite(false)
+		, width(0)
+		, height(0)
+		, tile_width(0)
+		, tile_height(0)
+		, tilesets()
+		, layer_names()
+		, object_group_names()
+		, has_error(false)
+		, error_code(0)
+		, error_text()
+	{}
+
+	void MapInfo::ParseFile(const string &fileName) 
+	{
+		FILE *file = fopen(fileName.c_str(), "rb");
+
+		// Check if the file could not be opened.
+		if (!file) 
+		{
+			has_error = true;
+			error_code = TMX_COULDNT_OPEN;
+			error_text = "Could not open the file.";
+			return;
+		}
+
+		// Find out the file size.
+		fseek(file, 0, SEEK_END);
+		long fileSize = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		// Check if the file size is valid.
+		if (fileSize <= 0) 
+		{
+			fclose(file);
+			has_error = true;
+			error_code = TMX_INVALID_FILE_SIZE;
+			error_text = "The size of the file is invalid.";
+			return;
+		}
+
+		string text(fileSize, '\0');
+		size_t numRead = fread(&text[0], 1, fileSize, file);
+		fclose(file);
+		text.resize(numRead);
+
+		ParseText(text);
+	}
+
+	void MapInfo::ParseText(const string &text) 
+	{
+		// Copy the document without the contents of any data element, which
+		// hold the tiles of layers and chunks. The end of a data element is
+		// found by scanning for its closing tag instead of parsing the payload.
+		string outline;
+		size_t pos = 0;
+		for (;;) 
+		{
+			size_t dataStart = text.find("<data", pos);
+			if (dataStart == string::npos) 
+			{
+				outline.append(text, pos, string::npos);
+				break;
+			}
+
+			size_t tagEnd = text.find('>', dataStart);
+			if (tagEnd == string::npos) 
+			{
+				outline.append(text, pos, string::npos);
+				break;
+			}
+
+			outline.append(text, pos, tagEnd + 1 - pos);
+			pos = tagEnd + 1;
+
+			// An empty element has no payload to skip.
+			if (text[tagEnd - 1] == '/') 
+			{
+				continue;
+			}
+
+			size_t dataEnd = text.find("</data>", pos);
+			if (dataEnd == string::npos) 
+			{
+				break;
+			}
+
+			pos = dataEnd;
+		}
+
+		TiXmlDocument doc;
+		doc.Parse(outline.c_str());
+
+		// Check for parsing errors.
+		if (doc.Error()) 
+		{
+			has_error = true;
+			error_code = TMX_PARSING_ERROR;
+			error_text = doc.ErrorDesc();
+			return;
+		}
+
+		const TiXmlNode *mapNode = doc.FirstChild("map");
+		if (!mapNode) 
+		{
+			has_error = true;
+			error_code = TMX_PARSING_ERROR;
+			error_text = "The document has no map element.";
+			return;
+		}
+
+		const TiXmlElement *mapElem = mapNode->ToElement();
+
+		// Read the map attributes.
+		int infiniteAttr = 0;
+		mapElem->Attribute("version", &version);
+		mapElem->Attribute("width", &width);
+		mapElem->Attribute("height", &height);
+		mapElem->Attribute("tilewidth", &tile_width);
+		mapElem->Attribute("tileheight", &tile_height);
+		mapElem->Attribute("infinite", &infiniteAttr);
+		infinite = infiniteAttr != 0;
+
+		const char *orientationStr = mapElem->Attribute("orientation");
+		if (orientationStr && !strcmp(orientationStr, "isometric")) 
+		{
+			orientation = TMX_MO_ISOMETRIC;
+		}
+
+		// Walk the children in document order.
+		for (const TiXmlNode *node = mapNode->FirstChild(); node; node = node->NextSibling()) 
+		{
+			const TiXmlElement *elem = node->ToElement();
+			if (!elem) 
+			{
+				continue;
+			}
+
+			const char *nameStr = elem->Attribute("name");
+			if (!strcmp(elem->Value(), "tileset")) 
+			{
+				TilesetInfo tileset;
+				tileset.firstGid = 0;
+				elem->Attribute("firstgid", &tileset.firstGid);
+
+				const char *sourceStr = elem->Attribute("source");
+				if (nameStr) tileset.name = nameStr;
+				if (sourceStr) tileset.source = sourceStr;
+
+				tilesets.push_back(tileset);
+			}
+			else if (!strcmp(elem->Value(), "layer")) 
+			{
+				layer_names.push_back(nameStr ? nameStr : "");
+			}
+			else if (!strcmp(elem->Value(), "objectgroup")) 
+			{
+				object_group_names.push_back(nameStr ? nameStr : "");
+			}
+		}
+	}
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "TmxMap.h"
+
+namespace Tmx 
+{
+	//-------------------------------------------------------------------------
+	// Reference to a tileset as written in the map.
+	//-------------------------------------------------------------------------
+	struct TilesetInfo 
+	{
+		// Global id of the first tile.
+		int firstGid;
+
+		// Name of an inline tileset, empty for external tilesets.
+		std::string name;
+
+		// File of an external tileset as written in the map, empty if inline.
+		std::string source;
+	};
+
+	//-------------------------------------------------------------------------
+	// A summary of a TMX file without any of its tile data.
+	// The layer payloads are skipped without being parsed or decoded, which
+	// makes this much cheaper than Map for tools that only need dimensions,
+	// tileset references and the names of layers and object groups.
+	//-------------------------------------------------------------------------
+	class MapInfo 
+	{
+	public:
+		MapInfo();
+
+		// Read a file and scan it.
+		void ParseFile(const std::string &fileName);
+
+		// Scan text containing TMX formatted XML.
+		void ParseText(const std::string &text);
+
+		// Get the version of the map.
+		double GetVersion() const { return version; }
+
+		// Get the orientation of the map.
+		Tmx::MapOrientation GetOrientation() const { return orientation; }
+
+		// Get whether the map is infinite.
+		bool IsInfinite() const { return infinite; }
+
+		// Get the width of the map, in tiles.
+		int GetWidth() const { return width; }
+
+		// Get the height of the map, in tiles.
+		int GetHeight() const { return height; }
+
+		// Get the width of a tile, in pixels.
+		int GetTileWidth() const { return tile_width; }
+
+		// Get the height of a tile, in pixels.
+		int GetTileHeight() const { return tile_height; }
+
+		// Get the tilesets referenced by the map.
+		const std::vector< Tmx::TilesetInfo > &GetTilesets() const { return tilesets; }
+
+		// Get the names of all layers.
+		const std::vector< std::string > &GetLayerNames() const { return layer_names; }
+
+		// Get the names of all object groups.
+		const std::vector< std::string > &GetObjectGroupNames() const { return object_group_names; }
+
+		// Get whether there was an error or not.
+		bool HasError() const { return has_error; }
+
+		// Get an error string containing the error in text format.
+		const std::string &GetErrorText() const { return error_text; }
+
+		// Get a number that identifies the error. (TMX_ preceded constants)
+		unsigned char GetErrorCode() const { return error_code; }
+
+	private:
+		double version;
+		Tmx::MapOrientation orientation;
+		bool infinite;
+
+		int width;
+		int height;
+		int tile_width;
+		int tile_height;
+
+		std::vector< Tmx::TilesetInfo > tilesets;
+		std::vector< std::string > layer_names;
+		std::vector< std::string > object_group_names;
+
+		bool has_error;
+		unsigned char error_code;
+		std::string error_text;
+	};
+};
@@ -27,6 +27,7 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxObject.h"
+#include "TmxSnapshot.h"
 #include "TmxPolygon.h"
 #include "TmxPolyline.h"
 
@@ -40,24 +41,15 @@ namespace Tmx
 		, width(0)
 		, height(0)
 		, gid(0)
-		, polygon(0)
-		, polyline(0)
+		, polygon()
+		, polyline()
 		, properties() 
 	{}
 
-	Object::~Object() 
-	{
-		if (polygon != 0)
-		{
-			delete polygon;
-			polygon = 0;
-		}
-		if (polyline != 0)
-		{
-			delete polyline;
-			polyline = 0;
-		}
-	}
+	// Defined here, where Polygon and Polyline are complete types.
+	Object::Object(Object &&_object) = default;
+	Object &Object::operator=(Object &&_object) = default;
+	Object::~Object() = default;
 
 	void Object::Parse(const TiXmlNode *objectNode) 
 	{
@@ -80,19 +72,13 @@ namespace Tmx
 		const TiXmlNode *polygonNode = objectNode->FirstChild("polygon");
 		if (polygonNode)
 		{
-			if (polygon != 0)
-				delete polygon;
-
-			polygon = new Polygon();
+			polygon.reset(new Polygon());
 			polygon->Parse(polygonNode);
 		}
 		const TiXmlNode *polylineNode = objectNode->FirstChild("polyline");
 		if (polylineNode)
 		{
-			if (polyline != 0)
-				delete polyline;
-
-			polyline = new Polyline();
+			polyline.reset(new Polyline());
 			polyline->Parse(polylineNode);
 		}
 
@@ -103,4 +89,54 @@ namespace Tmx
 			properties.Parse(propertiesNode);
 		}
 	}
+
+	void Object::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteString(name);
+		writer.WriteString(type);
+		writer.WriteInt(x);
+		writer.WriteInt(y);
+		writer.WriteInt(width);
+		writer.WriteInt(height);
+		writer.WriteInt(gid);
+
+		writer.WriteInt(polygon != NULL);
+		if (polygon)
+		{
+			polygon->Save(writer);
+		}
+
+		writer.WriteInt(polyline != NULL);
+		if (polyline)
+		{
+			polyline->Save(writer);
+		}
+
+		properties.Save(writer);
+	}
+
+	void Object::Load(SnapshotReader &reader) 
+	{
+		name = reader.ReadString();
+		type = reader.ReadString();
+		x = reader.ReadInt();
+		y = reader.ReadInt();
+		width = reader.ReadInt();
+		height = reader.ReadInt();
+		gid = reader.ReadInt();
+
+		if (reader.ReadInt())
+		{
+			polygon.reset(new Polygon());
+			polygon->Load(reader);
+		}
+
+		if (reader.ReadInt())
+		{
+			polyline.reset(new Polyline());
+			polyline->Load(reader);
+		}
+
+		properties.Load(reader);
+	}
 };
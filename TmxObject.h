@@ -27,6 +27,7 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "TmxPropertySet.h"
@@ -35,6 +36,8 @@ class TiXmlNode;
 
 namespace Tmx 
 {
+	class SnapshotReader;
+	class SnapshotWriter;
 	class Polygon;
 	class Polyline;
 
@@ -45,10 +48,18 @@ namespace Tmx
 	{
 	public:
 		Object();
+		Object(Object &&_object);
+		Object &operator=(Object &&_object);
 		~Object();
 
 		// Parse an object node.
 		void Parse(const TiXmlNode *objectNode);
+
+		// Write the object into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the object back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
 	
 		// Get the name of the object.
 		const std::string &GetName() const { return name; }
@@ -72,10 +83,10 @@ namespace Tmx
 		int GetGid() const { return gid; }
 
 		// Get the Polygon.
-		const Tmx::Polygon *GetPolygon() const { return polygon; }
+		const Tmx::Polygon *GetPolygon() const { return polygon.get(); }
 
 		// Get the Polyline.
-		const Tmx::Polyline *GetPolyline() const { return polyline; }
+		const Tmx::Polyline *GetPolyline() const { return polyline.get(); }
 
 		// Get the property set.
 		const Tmx::PropertySet &GetProperties() const { return properties; }
@@ -90,8 +101,8 @@ namespace Tmx
 		int height;
 		int gid;
 
-		Tmx::Polygon *polygon;
-		Tmx::Polyline *polyline;
+		std::unique_ptr< Tmx::Polygon > polygon;
+		std::unique_ptr< Tmx::Polyline > polyline;
 
 		Tmx::PropertySet properties;
 	};
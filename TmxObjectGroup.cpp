@@ -27,7 +27,7 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxObjectGroup.h"
-#include "TmxObject.h"
+#include "TmxSnapshot.h"
 
 namespace Tmx 
 {
@@ -35,17 +35,10 @@ namespace Tmx
 		: name()
 		, width(0)
 		, height(0)
+		, visible(1)
+		, objects()
 	{}
 
-	ObjectGroup::~ObjectGroup() 
-	{
-		for(std::size_t i = 0; i < objects.size(); i++)
-		{
-			Object *obj = objects.at(i);
-			delete obj;
-		}
-	}
-
 	void ObjectGroup::Parse(const TiXmlNode *objectGroupNode) 
 	{
 		const TiXmlElement *objectGroupElem = objectGroupNode->ToElement();
@@ -61,15 +54,41 @@ namespace Tmx
 		const TiXmlNode *objectNode = objectGroupNode->FirstChild("object");
 		while (objectNode) 
 		{
-			// Allocate a new object and parse it.
-			Object *object = new Object();
-			object->Parse(objectNode);
-			
-			// Add the object to the list.
-			objects.push_back(object);
+			// Add a new object to the list and parse it.
+			objects.emplace_back();
+			objects.back().Parse(objectNode);
 
 			objectNode = objectGroupNode->IterateChildren("object", objectNode);
 		}
 	}
 
+	void ObjectGroup::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteString(name);
+		writer.WriteInt(width);
+		writer.WriteInt(height);
+		writer.WriteInt(visible);
+
+		writer.WriteInt(objects.size());
+		for (std::size_t i = 0; i < objects.size(); i++)
+		{
+			objects[i].Save(writer);
+		}
+	}
+
+	void ObjectGroup::Load(SnapshotReader &reader) 
+	{
+		name = reader.ReadString();
+		width = reader.ReadInt();
+		height = reader.ReadInt();
+		visible = reader.ReadInt();
+
+		int numObjects = reader.ReadCount(8);
+		objects.reserve(numObjects);
+		for (int i = 0; i < numObjects; i++)
+		{
+			objects.emplace_back();
+			objects.back().Load(reader);
+		}
+	}
 };
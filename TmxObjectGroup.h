@@ -30,11 +30,14 @@
 #include <string>
 #include <vector>
 
+#include "TmxObject.h"
+
 class TiXmlNode;
 
 namespace Tmx 
 {
-	class Object;
+	class SnapshotReader;
+	class SnapshotWriter;
 	
 	//-------------------------------------------------------------------------
 	// A class used for holding a list of objects.
@@ -44,11 +47,16 @@ namespace Tmx
 	{
 	public:
 		ObjectGroup();
-		~ObjectGroup();
 
 		// Parse an objectgroup node.
 		void Parse(const TiXmlNode *objectGroupNode);
 
+		// Write the object group into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the object group back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
+
 		// Get the name of the object group.
 		const std::string &GetName() const { return name; }
 
@@ -61,7 +69,7 @@ namespace Tmx
 		int GetHeight() const { return height; }
 
 		// Get a single object.
-		const Tmx::Object *GetObject(int index) const { return objects.at(index); }
+		const Tmx::Object *GetObject(int index) const { return &objects.at(index); }
 
 		// Get the number of objects in the list.
 		int GetNumObjects() const { return objects.size(); }
@@ -70,7 +78,7 @@ namespace Tmx
 		int GetVisibility() const { return visible; }
 
 		// Get the whole list of objects.
-		const std::vector< Tmx::Object* > &GetObjects() const { return objects; }
+		const std::vector< Tmx::Object > &GetObjects() const { return objects; }
 
 	private:
 		std::string name;
@@ -79,6 +87,6 @@ namespace Tmx
 		int height;
 		int visible;
 
-		std::vector< Tmx::Object* > objects;
+		std::vector< Tmx::Object > objects;
 	};
 };
@@ -27,6 +27,8 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxPolygon.h"
+#include "TmxSnapshot.h"
+#include "TmxUtil.h"
 
 namespace Tmx 
 {
@@ -37,19 +39,24 @@ namespace Tmx
 
 	void Polygon::Parse(const TiXmlNode *polygonNode)
 	{
-		char *pointsLine = strdup(polygonNode->ToElement()->Attribute("points"));
-		
-		char *token = strtok(pointsLine, " ");
-		while (token)
-		{
-			Point point;
-			sscanf(token, "%d,%d", &point.x, &point.y);
-
-			points.push_back(point);
+		Util::ParsePoints(polygonNode->ToElement()->Attribute("points"), points);
+	}
 
-			token = strtok(0, " ");
+	void Polygon::Save(SnapshotWriter &writer) const
+	{
+		writer.WriteInt(points.size());
+		if (!points.empty())
+		{
+			writer.WriteBytes(&points[0], points.size() * sizeof(Point));
 		}
+	}
 
-		free(pointsLine);
+	void Polygon::Load(SnapshotReader &reader)
+	{
+		points.resize(reader.ReadCount(sizeof(Point)));
+		if (!points.empty())
+		{
+			reader.ReadBytes(&points[0], points.size() * sizeof(Point));
+		}
 	}
 }
@@ -27,6 +27,8 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxPolyline.h"
+#include "TmxSnapshot.h"
+#include "TmxUtil.h"
 
 namespace Tmx 
 {
@@ -37,19 +39,24 @@ namespace Tmx
 
 	void Polyline::Parse(const TiXmlNode *polylineNode)
 	{
-		char *pointsLine = strdup(polylineNode->ToElement()->Attribute("points"));
-		
-		char *token = strtok(pointsLine, " ");
-		while (token)
-		{
-			Point point;
-			sscanf(token, "%d,%d", &point.x, &point.y);
-
-			points.push_back(point);
+		Util::ParsePoints(polylineNode->ToElement()->Attribute("points"), points);
+	}
 
-			token = strtok(0, " ");
+	void Polyline::Save(SnapshotWriter &writer) const
+	{
+		writer.WriteInt(points.size());
+		if (!points.empty())
+		{
+			writer.WriteBytes(&points[0], points.size() * sizeof(Point));
 		}
+	}
 
-		free(pointsLine);
+	void Polyline::Load(SnapshotReader &reader)
+	{
+		points.resize(reader.ReadCount(sizeof(Point)));
+		if (!points.empty())
+		{
+			reader.ReadBytes(&points[0], points.size() * sizeof(Point));
+		}
 	}
 }
@@ -35,6 +35,9 @@ class TiXmlNode;
 
 namespace Tmx
 {
+	class SnapshotReader;
+	class SnapshotWriter;
+
 	//-------------------------------------------------------------------------
 	// Class to store a Polyline of an Object.
 	//-------------------------------------------------------------------------
@@ -46,12 +49,21 @@ namespace Tmx
 		// Parse the polyline node.
 		void Parse(const TiXmlNode *polylineNode);
 
+		// Write the polyline into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the polyline back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
+
 		// Get one of the vertices.
 		const Tmx::Point &GetPoint(int index) const { return points[index]; }
 
 		// Get the number of vertices.
 		int GetNumPoints() const { return points.size(); }
 
+		// Get the whole list of vertices.
+		const std::vector< Tmx::Point > &GetPoints() const { return points; }
+
 	private:
 		std::vector< Tmx::Point > points;
 	};
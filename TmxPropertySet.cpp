@@ -27,6 +27,7 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxPropertySet.h"
+#include "TmxSnapshot.h"
 
 using std::string;
 using std::map;
@@ -69,9 +70,37 @@ namespace Tmx
 		return iter->second;
 	}
 
+	bool PropertySet::HasProperty(const string &name) const 
+	{
+		return properties.find(name) != properties.end();
+	}
+
 	int PropertySet::GetNumericProperty(const string &name) const 
 	{
 		return atoi(GetLiteralProperty(name).c_str());
 	}
 
+	void PropertySet::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteInt(properties.size());
+
+		map< string, string >::const_iterator iter;
+		for (iter = properties.begin(); iter != properties.end(); ++iter) 
+		{
+			writer.WriteString(iter->first);
+			writer.WriteString(iter->second);
+		}
+	}
+
+	void PropertySet::Load(SnapshotReader &reader) 
+	{
+		properties.clear();
+
+		int numProperties = reader.ReadCount(8);
+		for (int i = 0; i < numProperties; i++) 
+		{
+			string propertyName = reader.ReadString();
+			properties[propertyName] = reader.ReadString();
+		}
+	}
 };
@@ -34,6 +34,9 @@ class TiXmlNode;
 
 namespace Tmx 
 {
+	class SnapshotReader;
+	class SnapshotWriter;
+
 	//-----------------------------------------------------------------------------
 	// This class contains a map of properties.
 	//-----------------------------------------------------------------------------
@@ -44,6 +47,12 @@ namespace Tmx
 
 		// Parse a node containing all the property nodes.
 		void Parse(const TiXmlNode *propertiesNode);
+
+		// Write the properties into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the properties back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
 	
 		// Get a numeric property (integer).
 		int GetNumericProperty(const std::string &name) const;
@@ -51,6 +60,9 @@ namespace Tmx
 		// Get a literal property (string).
 		std::string GetLiteralProperty(const std::string &name) const;
 
+		// Check if a property is set.
+		bool HasProperty(const std::string &name) const;
+
 		// Returns the amount of properties.
 		int GetSize() const { return properties.size(); }
 
@@ -0,0 +1,89 @@
+#include <string.h>
+
+#include "TmxSnapshot.h"
+
+using std::string;
+
+namespace Tmx 
+{
+	SnapshotWriter::SnapshotWriter() 
+		: data()
+	{}
+
+	void SnapshotWriter::WriteInt(int value) 
+	{
+		WriteBytes(&value, sizeof(value));
+	}
+
+	void SnapshotWriter::WriteDouble(double value) 
+	{
+		WriteBytes(&value, sizeof(value));
+	}
+
+	void SnapshotWriter::WriteString(const string &value) 
+	{
+		WriteInt(value.size());
+		WriteBytes(value.data(), value.size());
+	}
+
+	void SnapshotWriter::WriteBytes(const void *bytes, int size) 
+	{
+		const char *begin = (const char *)bytes;
+		data.insert(data.end(), begin, begin + size);
+	}
+
+	SnapshotReader::SnapshotReader(const char *_data, int _size) 
+		: data(_data)
+		, size(_size)
+		, pos(0)
+		, has_error(false)
+	{}
+
+	int SnapshotReader::ReadInt() 
+	{
+		int value = 0;
+		ReadBytes(&value, sizeof(value));
+		return value;
+	}
+
+	double SnapshotReader::ReadDouble() 
+	{
+		double value = 0.0;
+		ReadBytes(&value, sizeof(value));
+		return value;
+	}
+
+	string SnapshotReader::ReadString() 
+	{
+		int length = ReadCount(1);
+		string value(data + pos, length);
+		pos += length;
+		return value;
+	}
+
+	bool SnapshotReader::ReadBytes(void *out, int count) 
+	{
+		if (has_error || count < 0 || count > size - pos) 
+		{
+			has_error = true;
+			memset(out, 0, count > 0 ? count : 0);
+			return false;
+		}
+
+		memcpy(out, data + pos, count);
+		pos += count;
+		return true;
+	}
+
+	int SnapshotReader::ReadCount(int elementSize) 
+	{
+		int count = ReadInt();
+		if (count < 0 || (elementSize > 0 && count > (size - pos) / elementSize)) 
+		{
+			has_error = true;
+			return 0;
+		}
+
+		return count;
+	}
+};
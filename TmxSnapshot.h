@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Tmx 
+{
+	//-------------------------------------------------------------------------
+	// Collects the binary snapshot of a map.
+	// Values are written in native byte order, a snapshot is only meant to
+	// be read back on the machine that wrote it.
+	//-------------------------------------------------------------------------
+	class SnapshotWriter 
+	{
+	public:
+		SnapshotWriter();
+
+		// Append an integer.
+		void WriteInt(int value);
+
+		// Append a floating point value.
+		void WriteDouble(double value);
+
+		// Append a string, prefixed with its length.
+		void WriteString(const std::string &value);
+
+		// Append raw bytes.
+		void WriteBytes(const void *data, int size);
+
+		// Get the snapshot written so far.
+		const std::vector< char > &GetData() const { return data; }
+
+	private:
+		std::vector< char > data;
+	};
+
+	//-------------------------------------------------------------------------
+	// Reads back a snapshot from memory.
+	// Reading past the end sets the error flag and returns zeros.
+	//-------------------------------------------------------------------------
+	class SnapshotReader 
+	{
+	public:
+		SnapshotReader(const char *_data, int _size);
+
+		// Read an integer.
+		int ReadInt();
+
+		// Read a floating point value.
+		double ReadDouble();
+
+		// Read a length prefixed string.
+		std::string ReadString();
+
+		// Copy raw bytes, returns false if not enough data is left.
+		bool ReadBytes(void *out, int size);
+
+		// Read a count that must be followed by at least elementSize bytes
+		// for every element, returns 0 and sets the error flag otherwise.
+		int ReadCount(int elementSize);
+
+		// Get whether the snapshot was truncated or corrupt.
+		bool HasError() const { return has_error; }
+
+	private:
+		const char *data;
+		int size;
+		int pos;
+		bool has_error;
+	};
+};
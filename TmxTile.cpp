@@ -27,13 +27,11 @@
 //-----------------------------------------------------------------------------
 #include "tinyxml.h"
 #include "TmxTile.h"
+#include "TmxSnapshot.h"
 
 namespace Tmx 
 {
-	Tile::Tile() : properties()
-	{}
-
-	Tile::~Tile() 
+	Tile::Tile() : properties(), frames()
 	{}
 
 	void Tile::Parse(const TiXmlNode *tileNode) 
@@ -50,5 +48,50 @@ namespace Tmx
 		{
 			properties.Parse(propertiesNode);
 		}
+
+		// Parse the animation frames if any.
+		const TiXmlNode *animationNode = tileNode->FirstChild("animation");
+
+		if (animationNode) 
+		{
+			const TiXmlNode *frameNode = animationNode->FirstChild("frame");
+			while (frameNode) 
+			{
+				const TiXmlElement *frameElem = frameNode->ToElement();
+
+				AnimationFrame frame = { 0, 0 };
+				frameElem->Attribute("tileid", &frame.tile_id);
+				frameElem->Attribute("duration", &frame.duration);
+				frames.push_back(frame);
+
+				frameNode = animationNode->IterateChildren("frame", frameNode);
+			}
+		}
+	}
+
+	void Tile::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteInt(id);
+		properties.Save(writer);
+
+		writer.WriteInt(frames.size());
+		for (unsigned int i = 0; i < frames.size(); i++) 
+		{
+			writer.WriteInt(frames[i].tile_id);
+			writer.WriteInt(frames[i].duration);
+		}
+	}
+
+	void Tile::Load(SnapshotReader &reader) 
+	{
+		id = reader.ReadInt();
+		properties.Load(reader);
+
+		frames.resize(reader.ReadCount(2 * sizeof(int)));
+		for (unsigned int i = 0; i < frames.size(); i++) 
+		{
+			frames[i].tile_id = reader.ReadInt();
+			frames[i].duration = reader.ReadInt();
+		}
 	}
 };
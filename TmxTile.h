@@ -27,10 +27,25 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#include <vector>
+
 #include "TmxPropertySet.h"
 
 namespace Tmx 
 {
+	class SnapshotReader;
+	class SnapshotWriter;
+
+	//-------------------------------------------------------------------------
+	// A frame of a tile animation: the tile shown (relative to the tileset)
+	// and for how many milliseconds it is shown.
+	//-------------------------------------------------------------------------
+	struct AnimationFrame
+	{
+		int tile_id;
+		int duration;
+	};
+
 	//-------------------------------------------------------------------------
 	// Class to contain information about every tile in the tileset/tiles 
 	// element.
@@ -42,10 +57,15 @@ namespace Tmx
 	{
 	public:
 		Tile();
-		~Tile();
 	
 		// Parse a tile node.
 		void Parse(const TiXmlNode *tileNode);
+
+		// Write the tile into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the tile back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
 		
 		// Get the Id. (relative to the tilset)
 		int GetId() const { return id; }
@@ -53,9 +73,16 @@ namespace Tmx
 		// Get a set of properties regarding the tile.
 		const Tmx::PropertySet &GetProperties() const { return properties; }
 
+		// Get the frames of the animation, empty if the tile is not animated.
+		const std::vector< Tmx::AnimationFrame > &GetFrames() const { return frames; }
+
+		// Returns true if the tile has an animation.
+		bool IsAnimated() const { return !frames.empty(); }
+
 	private:
 		int id;
 
 		Tmx::PropertySet properties;
+		std::vector< Tmx::AnimationFrame > frames;
 	};
 };
@@ -25,85 +25,108 @@
 //
 // Author: Tamir Atias
 //-----------------------------------------------------------------------------
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+
 #include "tinyxml.h"
 #include "TmxTileset.h"
-#include "TmxImage.h"
-#include "TmxTile.h"
+#include "TmxSnapshot.h"
 
 using std::vector;
 using std::string;
 
 namespace Tmx 
 {
+	//-------------------------------------------------------------------------
+	// An external tileset loaded into the cache.
+	//-------------------------------------------------------------------------
+	struct ExternalTileset 
+	{
+		time_t mtime;
+		off_t size;
+		std::shared_ptr< const Tileset > tileset;
+	};
+
+	// Loaded external tilesets by file name. Tilesets replaced after the file
+	// changed stay alive as long as maps share their data.
+	static std::map< string, ExternalTileset > externalTilesets;
+	static std::mutex externalMutex;
+
+	// Returned for tilesets without tiles.
+	static const vector< Tile > noTiles;
+
 	Tileset::Tileset() 
 		: first_gid(0)
+		, source()
 		, name()
+		, tile_count(0)
 		, tile_width(0)
 		, tile_height(0)
 		, margin(0)
 		, spacing(0)
-		, image(NULL)
+		, image()
 		, tiles()
 	{
 	}
 
-	Tileset::~Tileset() 
+	void Tileset::Parse(const TiXmlNode *tilesetNode, const string &filePath) 
 	{
-		// Delete the image from memory if allocated.
-		if (image) 
-		{
-			delete image;
-			image = NULL;
-		}
-		
-		// Iterate through all of the tiles in the set and delete each of them.
-		vector< Tile* >::iterator tIter;
-		for (tIter = tiles.begin(); tIter != tiles.end(); ++tIter) 
+		const TiXmlElement *tilesetElem = tilesetNode->ToElement();
+
+		// Read all the attributes into local variables.
+		tilesetElem->Attribute("firstgid", &first_gid);
+
+		// An external tileset only gives the first gid and the file name.
+		const char *sourceStr = tilesetElem->Attribute("source");
+		if (sourceStr) 
 		{
-			Tile *tile = (*tIter);
-			
-			if (tile) 
+			source = filePath + sourceStr;
+
+			std::shared_ptr< const Tileset > external = LoadExternal(source);
+			if (external) 
 			{
-				delete tile;
-				tile = NULL;
+				Assign(*external);
 			}
+			return;
 		}
-	}
 
-	void Tileset::Parse(const TiXmlNode *tilesetNode) 
-	{
-		const TiXmlElement *tilesetElem = tilesetNode->ToElement();
-
-		// Read all the attributes into local variables.
-		tilesetElem->Attribute("firstgid", &first_gid);
 		tilesetElem->Attribute("tilewidth", &tile_width);
 		tilesetElem->Attribute("tileheight", &tile_height);
 		tilesetElem->Attribute("margin", &margin);
 		tilesetElem->Attribute("spacing", &spacing);
+		tilesetElem->Attribute("tilecount", &tile_count);
 
-		name = tilesetElem->Attribute("name");
+		const char *nameStr = tilesetElem->Attribute("name");
+		if (nameStr) 
+		{
+			name = nameStr;
+		}
 
 		// Parse the image.
 		const TiXmlNode *imageNode = tilesetNode->FirstChild("image");
 		
 		if (imageNode) 
 		{
-			image = new Image();
-			image->Parse(imageNode);
+			std::shared_ptr< Image > newImage = std::make_shared< Image >();
+			newImage->Parse(imageNode);
+			image = newImage;
 		}
 
 		// Iterate through all of the tile elements and parse each.
 		const TiXmlNode *tileNode = tilesetNode->FirstChild("tile");
-		while (tileNode)
+		if (tileNode) 
 		{
-			// Allocate a new tile and parse it.
-			Tile *tile = new Tile();
-			tile->Parse(tileNode);
-
-			// Add the tile to the collection.
-			tiles.push_back(tile);
+			std::shared_ptr< vector< Tile > > newTiles = std::make_shared< vector< Tile > >();
+			while (tileNode)
+			{
+				// Add a new tile to the collection and parse it.
+				newTiles->emplace_back();
+				newTiles->back().Parse(tileNode);
 
-			tileNode = tilesetNode->IterateChildren("tile", tileNode);
+				tileNode = tilesetNode->IterateChildren("tile", tileNode);
+			}
+			tiles = newTiles;
 		}
 		
 		// Parse the properties if any.
@@ -115,16 +138,144 @@ namespace Tmx
 		}
 	}
 
+	void Tileset::Assign(const Tileset &external) 
+	{
+		name = external.name;
+		tile_count = external.tile_count;
+		tile_width = external.tile_width;
+		tile_height = external.tile_height;
+		margin = external.margin;
+		spacing = external.spacing;
+		properties = external.properties;
+
+		// The image and the tiles are shared with the cached tileset.
+		image = external.image;
+		tiles = external.tiles;
+	}
+
+	std::shared_ptr< const Tileset > Tileset::LoadExternal(const string &fileName) 
+	{
+		struct stat st;
+		if (stat(fileName.c_str(), &st) != 0) 
+		{
+			return std::shared_ptr< const Tileset >();
+		}
+
+		std::lock_guard< std::mutex > lock(externalMutex);
+
+		std::map< string, ExternalTileset >::iterator iter = externalTilesets.find(fileName);
+		if (iter != externalTilesets.end()) 
+		{
+			if (iter->second.mtime == st.st_mtime && iter->second.size == st.st_size) 
+			{
+				return iter->second.tileset;
+			}
+
+			externalTilesets.erase(iter);
+		}
+
+		TiXmlDocument doc;
+		if (!doc.LoadFile(fileName.c_str())) 
+		{
+			return std::shared_ptr< const Tileset >();
+		}
+
+		const TiXmlNode *tilesetNode = doc.FirstChild("tileset");
+		if (!tilesetNode) 
+		{
+			return std::shared_ptr< const Tileset >();
+		}
+
+		std::shared_ptr< Tileset > tileset = std::make_shared< Tileset >();
+		tileset->Parse(tilesetNode);
+
+		ExternalTileset entry;
+		entry.mtime = st.st_mtime;
+		entry.size = st.st_size;
+		entry.tileset = tileset;
+		externalTilesets[fileName] = entry;
+
+		return tileset;
+	}
+
 	const Tile *Tileset::GetTile(int index) const 
 	{
-		for (unsigned int i = 0; i < tiles.size(); ++i) 
+		const vector< Tile > &allTiles = GetTiles();
+		for (unsigned int i = 0; i < allTiles.size(); ++i) 
 		{
-			if (tiles.at(i)->GetId() == index) 
+			if (allTiles[i].GetId() == index) 
 			{
-				return tiles.at(i);
+				return &allTiles[i];
 			}
 		}
 
 		return NULL;
 	}
+
+	const vector< Tile > &Tileset::GetTiles() const 
+	{
+		return tiles ? *tiles : noTiles;
+	}
+
+	void Tileset::Save(SnapshotWriter &writer) const 
+	{
+		writer.WriteInt(first_gid);
+		writer.WriteString(source);
+		writer.WriteString(name);
+		writer.WriteInt(tile_count);
+		writer.WriteInt(tile_width);
+		writer.WriteInt(tile_height);
+		writer.WriteInt(margin);
+		writer.WriteInt(spacing);
+
+		writer.WriteInt(image != NULL);
+		if (image) 
+		{
+			image->Save(writer);
+		}
+
+		const vector< Tile > &allTiles = GetTiles();
+		writer.WriteInt(allTiles.size());
+		for (unsigned int i = 0; i < allTiles.size(); ++i) 
+		{
+			allTiles[i].Save(writer);
+		}
+
+		properties.Save(writer);
+	}
+
+	void Tileset::Load(SnapshotReader &reader) 
+	{
+		// A loaded tileset never shares its data, external or not.
+		first_gid = reader.ReadInt();
+		source = reader.ReadString();
+		name = reader.ReadString();
+		tile_count = reader.ReadInt();
+		tile_width = reader.ReadInt();
+		tile_height = reader.ReadInt();
+		margin = reader.ReadInt();
+		spacing = reader.ReadInt();
+
+		if (reader.ReadInt()) 
+		{
+			std::shared_ptr< Image > newImage = std::make_shared< Image >();
+			newImage->Load(reader);
+			image = newImage;
+		}
+
+		int numTiles = reader.ReadCount(8);
+		if (numTiles > 0) 
+		{
+			std::shared_ptr< vector< Tile > > newTiles = std::make_shared< vector< Tile > >();
+			newTiles->reserve(numTiles);
+			for (int i = 0; i < numTiles; ++i) 
+			{
+				newTiles->emplace_back();
+				newTiles->back().Load(reader);
+			}
+			tiles = newTiles;
+		}
+
+		properties.Load(reader);
+	}
 };
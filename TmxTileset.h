@@ -27,17 +27,20 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "TmxPropertySet.h"
+#include "TmxImage.h"
+#include "TmxTile.h"
 
 class TiXmlNode;
 
 namespace Tmx 
 {
-	class Image;
-	class Tile;
+	class SnapshotReader;
+	class SnapshotWriter;
 
 	//-------------------------------------------------------------------------
 	// A class used for storing information about each of the tilesets.
@@ -48,14 +51,34 @@ namespace Tmx
 	{
 	public:
 		Tileset();
-		~Tileset();
 
 		// Parse a tileset element.
-		void Parse(const TiXmlNode *tilesetNode);
+		// External tilesets are loaded relative to filePath, the directory of
+		// the map, through a process-wide cache (see LoadExternal).
+		void Parse(const TiXmlNode *tilesetNode, const std::string &filePath = "");
+
+		// Write the tileset into a snapshot.
+		void Save(Tmx::SnapshotWriter &writer) const;
+
+		// Read the tileset back from a snapshot.
+		void Load(Tmx::SnapshotReader &reader);
+
+		// Load an external tileset (TSX) file.
+		// Each file is parsed once and kept in a process-wide cache, it is
+		// parsed again only when its modification time or size changed.
+		// The result is shared read-only between all maps and threads.
+		// Returns an empty pointer if the file could not be loaded.
+		static std::shared_ptr< const Tmx::Tileset > LoadExternal(const std::string &fileName);
 
 		// Returns the global id of the first tile.
 		int GetFirstGid() const { return first_gid; }
 
+		// Returns the path of the external tileset file, empty if inline.
+		const std::string &GetSource() const { return source; }
+
+		// Returns the amount of tiles in the tileset, 0 if not given.
+		int GetTileCount() const { return tile_count; }
+
 		// Returns the name of the tileset.
 		const std::string &GetName() const { return name; }
 
@@ -73,30 +96,38 @@ namespace Tmx
 
 		// Returns a variable containing information 
 		// about the image of the tileset.
-		const Tmx::Image* GetImage() const { return image; }
+		// This is NULL for image collection tilesets and
+		// external tilesets that failed to load.
+		const Tmx::Image* GetImage() const { return image.get(); }
 
 		// Returns a a single tile of the set.
 		const Tmx::Tile *GetTile(int index) const;
 
 		// Returns the whole tile collection.
-		const std::vector< Tmx::Tile *> &GetTiles() const { return tiles; } 
+		const std::vector< Tmx::Tile > &GetTiles() const;
 		
 		// Get a set of properties regarding the tile.
 		const Tmx::PropertySet &GetProperties() const { return properties; }
 
 	private:
+		// Share the data of an already loaded external tileset.
+		void Assign(const Tmx::Tileset &external);
+
 		int first_gid;
 		
+		std::string source;
 		std::string name;
 		
+		int tile_count;
 		int tile_width;
 		int tile_height;
 		int margin;
 		int spacing;
 		
-		Tmx::Image* image;
-
-		std::vector< Tmx::Tile* > tiles;
+		// The image and the tiles are shared with the external tileset
+		// cache for TSX files. Both are empty when not given.
+		std::shared_ptr< const Tmx::Image > image;
+		std::shared_ptr< const std::vector< Tmx::Tile > > tiles;
 		
 		Tmx::PropertySet properties;
 	};
@@ -27,6 +27,14 @@
 //-----------------------------------------------------------------------------
 #include <stdlib.h>
 #include <zlib.h>
+#include <thread>
+#include <atomic>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "TmxUtil.h"
 #include "base64.h"
@@ -37,6 +45,92 @@ namespace Tmx {
 		return base64_decode(str);
 	}
 
+	// Values of the base-64 characters, -1 for anything else.
+	static const signed char base64Values[256] = 
+	{
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+		52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+		-1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+		15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+		-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+		41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+	};
+
+	void Util::DecodeBase64(const char *text, int numQuads, unsigned char *out) 
+	{
+		const unsigned char *in = (const unsigned char *)text;
+
+		for (int i = 0; i < numQuads; i++, in += 4, out += 3) 
+		{
+			const unsigned value = 
+				(base64Values[in[0]] << 18) | (base64Values[in[1]] << 12) | 
+				(base64Values[in[2]] << 6) | base64Values[in[3]];
+
+			out[0] = (unsigned char)(value >> 16);
+			out[1] = (unsigned char)(value >> 8);
+			out[2] = (unsigned char)value;
+		}
+	}
+
+	bool Util::IsBase64(char c) 
+	{
+		return base64Values[(unsigned char)c] >= 0;
+	}
+
+	// Thread count set by SetNumThreads, 0 when not set.
+	static std::atomic< int > numThreadsOverride(0);
+
+	int Util::GetNumTasks(int size, int minSize) 
+	{
+		int numTasks = numThreadsOverride.load();
+		if (numTasks <= 0) 
+		{
+			numTasks = std::thread::hardware_concurrency();
+		}
+		if (numTasks > size / minSize) 
+		{
+			numTasks = size / minSize;
+		}
+
+		return numTasks > 1 ? numTasks : 1;
+	}
+
+	void Util::SetNumThreads(int numThreads) 
+	{
+		numThreadsOverride.store(numThreads);
+	}
+
+	void Util::ParallelFor(int numTasks, const std::function< void(int) > &task) 
+	{
+		std::vector< std::thread > threads;
+		threads.reserve(numTasks > 1 ? numTasks - 1 : 0);
+
+		for (int i = 1; i < numTasks; i++) 
+		{
+			threads.push_back(std::thread(task, i));
+		}
+
+		if (numTasks > 0) 
+		{
+			task(0);
+		}
+
+		for (unsigned int i = 0; i < threads.size(); i++) 
+		{
+			threads[i].join();
+		}
+	}
+
 	char *Util::DecompressGZIP(const char *data, int dataSize, int expectedSize) 
 	{
 		int bufferSize = expectedSize;
@@ -104,4 +198,152 @@ namespace Tmx {
 
 		return out;
 	}
+
+	void Util::ParsePoints(const char *text, std::vector< Point > &points) 
+	{
+		if (!text) 
+		{
+			return;
+		}
+
+		// Every point but the last is followed by a space.
+		int numPoints = 1;
+		for (const char *c = text; *c; ++c) 
+		{
+			if (*c == ' ') 
+			{
+				numPoints++;
+			}
+		}
+		points.reserve(points.size() + numPoints);
+
+		const char *cursor = text;
+		while (*cursor) 
+		{
+			char *end;
+			Point point;
+
+			point.x = (int)strtod(cursor, &end);
+			if (end == cursor || *end != ',') 
+			{
+				break;
+			}
+
+			cursor = end + 1;
+			point.y = (int)strtod(cursor, &end);
+			if (end == cursor) 
+			{
+				break;
+			}
+
+			points.push_back(point);
+
+			cursor = end;
+			while (*cursor == ' ') 
+			{
+				cursor++;
+			}
+		}
+	}
+
+	// Fill in a map tile from a gid and its already computed tileset index 
+	// and id.
+	static inline void StoreTile(MapTile &tile, unsigned gid, int tilesetId, unsigned id) 
+	{
+		tile.tilesetId = tilesetId;
+		tile.id = id;
+		tile.flippedHorizontally = (gid & FlippedHorizontallyFlag) != 0;
+		tile.flippedVertically = (gid & FlippedVerticallyFlag) != 0;
+		tile.flippedDiagonally = (gid & FlippedDiagonallyFlag) != 0;
+	}
+
+	void Util::ConvertGids(const unsigned *gids, int count, 
+		const std::vector< int > &firstGids, MapTile *tiles) 
+	{
+		const unsigned flagMask = FlippedHorizontallyFlag | FlippedVerticallyFlag | FlippedDiagonallyFlag;
+		const int numTilesets = firstGids.size();
+		int i = 0;
+
+		// Every tileset is tested against every gid and a later match 
+		// replaces an earlier one, so there are no branches per gid.
+#if defined(__AVX2__)
+		const __m256i vFlagMask = _mm256_set1_epi32(~flagMask);
+		for (; i + 8 <= count; i += 8) 
+		{
+			const __m256i vGid = _mm256_loadu_si256((const __m256i *)(gids + i));
+			const __m256i vClean = _mm256_and_si256(vGid, vFlagMask);
+			__m256i vIndex = _mm256_set1_epi32(-1);
+			__m256i vFirst = _mm256_setzero_si256();
+
+			for (int t = 0; t < numTilesets; t++) 
+			{
+				const __m256i vMatch = _mm256_cmpgt_epi32(vClean, _mm256_set1_epi32(firstGids[t] - 1));
+				vIndex = _mm256_blendv_epi8(vIndex, _mm256_set1_epi32(t), vMatch);
+				vFirst = _mm256_blendv_epi8(vFirst, _mm256_set1_epi32(firstGids[t]), vMatch);
+			}
+
+			int index[8];
+			unsigned id[8];
+			_mm256_storeu_si256((__m256i *)index, vIndex);
+			_mm256_storeu_si256((__m256i *)id, _mm256_sub_epi32(vClean, vFirst));
+
+			for (int k = 0; k < 8; k++) 
+			{
+				StoreTile(tiles[i + k], gids[i + k], index[k], id[k]);
+			}
+		}
+#elif defined(__SSE2__)
+		const __m128i vFlagMask = _mm_set1_epi32(~flagMask);
+		for (; i + 4 <= count; i += 4) 
+		{
+			const __m128i vGid = _mm_loadu_si128((const __m128i *)(gids + i));
+			const __m128i vClean = _mm_and_si128(vGid, vFlagMask);
+			__m128i vIndex = _mm_set1_epi32(-1);
+			__m128i vFirst = _mm_setzero_si128();
+
+			for (int t = 0; t < numTilesets; t++) 
+			{
+				const __m128i vMatch = _mm_cmpgt_epi32(vClean, _mm_set1_epi32(firstGids[t] - 1));
+				vIndex = _mm_or_si128(_mm_and_si128(vMatch, _mm_set1_epi32(t)), _mm_andnot_si128(vMatch, vIndex));
+				vFirst = _mm_or_si128(_mm_and_si128(vMatch, _mm_set1_epi32(firstGids[t])), _mm_andnot_si128(vMatch, vFirst));
+			}
+
+			int index[4];
+			unsigned id[4];
+			_mm_storeu_si128((__m128i *)index, vIndex);
+			_mm_storeu_si128((__m128i *)id, _mm_sub_epi32(vClean, vFirst));
+
+			for (int k = 0; k < 4; k++) 
+			{
+				StoreTile(tiles[i + k], gids[i + k], index[k], id[k]);
+			}
+		}
+#endif
+
+		// Whatever is left over, or everything without SIMD support.
+		ConvertGidsScalar(gids + i, count - i, firstGids, tiles + i);
+	}
+
+	void Util::ConvertGidsScalar(const unsigned *gids, int count, 
+		const std::vector< int > &firstGids, MapTile *tiles) 
+	{
+		const unsigned flagMask = FlippedHorizontallyFlag | FlippedVerticallyFlag | FlippedDiagonallyFlag;
+		const int numTilesets = firstGids.size();
+
+		for (int i = 0; i < count; i++) 
+		{
+			const int clean = gids[i] & ~flagMask;
+			int index = -1;
+			int first = 0;
+
+			for (int t = 0; t < numTilesets; t++) 
+			{
+				const bool match = clean >= firstGids[t];
+				index = match ? t : index;
+				first = match ? firstGids[t] : first;
+			}
+
+			StoreTile(tiles[i], gids[i], index, clean - first);
+		}
+	}
 };
@@ -27,7 +27,12 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#include <functional>
 #include <string>
+#include <vector>
+
+#include "TmxPoint.h"
+#include "TmxMapTile.h"
 
 namespace Tmx 
 {
@@ -37,7 +42,43 @@ namespace Tmx
 		// Decode a base-64 encoded string.
 		static std::string DecodeBase64(const std::string &str);
 
+		// Decode numQuads groups of 4 base-64 characters into 3 bytes each.
+		// The characters must have been checked with IsBase64.
+		static void DecodeBase64(const char *text, int numQuads, unsigned char *out);
+
+		// Get whether a character is part of the base-64 alphabet.
+		static bool IsBase64(char c);
+
+		// Get the number of threads worth using for size units of work when
+		// minSize units are the least worth a thread of their own.
+		static int GetNumTasks(int size, int minSize);
+
+		// Plan for numThreads threads in GetNumTasks instead of the hardware
+		// concurrency, 0 goes back to the hardware concurrency. Lets tests
+		// and benchmarks pick the split of parallel work.
+		static void SetNumThreads(int numThreads);
+
+		// Run task(0) to task(numTasks - 1) in parallel and wait for all of
+		// them. The first task runs on the calling thread.
+		static void ParallelFor(int numTasks, const std::function< void(int) > &task);
+
 		// Decompress a gzip encoded byte array.
 		static char* DecompressGZIP(const char *data, int dataSize, int expectedSize);
+
+		// Parse a list of points in the form "x,y x,y ..." in place.
+		// Fractional coordinates are truncated.
+		static void ParsePoints(const char *text, std::vector< Tmx::Point > &points);
+
+		// Convert an array of raw gids into map tiles.
+		// firstGids holds the first gid of every tileset of the map, a gid
+		// belongs to the last tileset whose first gid is not above it.
+		// Uses AVX2 or SSE2 when the compiler targets them.
+		static void ConvertGids(const unsigned *gids, int count, 
+			const std::vector< int > &firstGids, Tmx::MapTile *tiles);
+
+		// Same as ConvertGids without SIMD, the reference the vector paths
+		// must match.
+		static void ConvertGidsScalar(const unsigned *gids, int count, 
+			const std::vector< int > &firstGids, Tmx::MapTile *tiles);
 	};
 };
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include "anim_table.h"
+
+static bool compare_entry(const anim_entry &a, const anim_entry &b)
+{
+  return a.tile < b.tile;
+}
+
+void anim_table_build(anim_table *table, const std::vector<Tmx::Tile> &tiles, int num_tiles)
+{
+  for (unsigned int i = 0; i < tiles.size(); i++) {
+    const Tmx::Tile *tile = &tiles[i];
+    if (!tile->IsAnimated() || tile->GetId() >= num_tiles) {
+      continue;
+    }
+
+    anim_entry entry = { tile->GetId(), 0, (int) tile->GetFrames().size(), 0, 0 };
+    table->anims.push_back(entry);
+  }
+
+  std::sort(table->anims.begin(), table->anims.end(), compare_entry);
+
+  // Frames are stored in the order of the animations
+  for (unsigned int i = 0; i < table->anims.size(); i++) {
+    anim_entry *entry = &table->anims[i];
+    entry->first_frame = table->frames.size();
+
+    for (unsigned int j = 0; j < tiles.size(); j++) {
+      if (tiles[j].GetId() != entry->tile) {
+        continue;
+      }
+
+      const std::vector<Tmx::AnimationFrame> &frames = tiles[j].GetFrames();
+      for (unsigned int k = 0; k < frames.size(); k++) {
+        anim_frame frame = { frames[k].tile_id, frames[k].duration };
+        table->frames.push_back(frame);
+      }
+      break;
+    }
+  }
+}
+
+void anim_table_cells(anim_table *table, const std::vector<plane> &planes,
+                      const std::vector<const Tmx::Layer *> &layers, int width, int height, bool vertical)
+{
+  const int num_anims = table->anims.size();
+  if (num_anims == 0) {
+    return;
+  }
+
+  // Map a tile id to its animation, -1 for tiles that are not animated
+  std::vector<int> index(table->anims.back().tile + 1, -1);
+  for (int i = 0; i < num_anims; i++) {
+    index[table->anims[i].tile] = i;
+  }
+
+  std::vector<std::vector<anim_cell> > found(num_anims);
+  const int outer = vertical ? height : width;
+  const int inner = vertical ? width : height;
+
+  for (int o = 0; o < outer; o++) {
+    for (int n = 0; n < inner; n++) {
+      const int x = vertical ? n : o;
+      const int y = vertical ? o : n;
+
+      for (unsigned int i = 0; i < planes.size(); i++) {
+        const plane *p = &planes[i];
+        if (plane_tile_empty(p, layers, width, x, y)) {
+          continue;
+        }
+
+        const unsigned id = plane_tile_id(p, layers, width, x, y);
+        if (id < index.size() && index[id] >= 0) {
+          anim_cell cell = { (int) i, x, y };
+          found[index[id]].push_back(cell);
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < num_anims; i++) {
+    table->anims[i].first_cell = table->cells.size();
+    table->anims[i].num_cells = found[i].size();
+    table->cells.insert(table->cells.end(), found[i].begin(), found[i].end());
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef _ANIM_TABLE_H
+#define _ANIM_TABLE_H
+
+#include <vector>
+#include "flatten.h"
+
+// Animated tile with its run of frames and its run of cells in the table
+struct anim_entry
+{
+  int tile;
+  int first_frame;
+  int num_frames;
+  int first_cell;
+  int num_cells;
+};
+
+// Tile shown by a frame and how long it stays, in milliseconds
+struct anim_frame
+{
+  int tile;
+  int duration;
+};
+
+// Map cell holding an animated tile, in tiles from the top left of the map
+struct anim_cell
+{
+  int plane;
+  int x;
+  int y;
+};
+
+// Animations of the tileset and the cells of the map that show them
+struct anim_table
+{
+  std::vector<anim_entry> anims;
+  std::vector<anim_frame> frames;
+  std::vector<anim_cell> cells;
+};
+
+// Collect the animated tiles below num_tiles in tile id order along with their frames
+void anim_table_build(anim_table *table, const std::vector<Tmx::Tile> &tiles, int num_tiles);
+
+// Find the cells of every plane showing an animated tile, grouped by animation and
+// sorted along the scroll axis so the visible cells of an animation form one run
+void anim_table_cells(anim_table *table, const std::vector<plane> &planes,
+                      const std::vector<const Tmx::Layer *> &layers, int width, int height, bool vertical);
+
+#endif
@@ -0,0 +1,116 @@
+#include "area_grid.h"
+
+static bool area_contains(const area_rect &area, int px, int py)
+{
+  return px >= area.x && px < area.x + area.width &&
+         py >= area.y && py < area.y + area.height;
+}
+
+static int clamp_cell(int value, int max)
+{
+  if (value < 0) {
+    return 0;
+  }
+  else if (value > max) {
+    return max;
+  }
+
+  return value;
+}
+
+bool area_grid_build(area_grid *grid, const std::vector<area_rect> &areas, int map_width, int map_height, int cell_width, int cell_height)
+{
+  grid->cell_width = cell_width;
+  grid->cell_height = cell_height;
+  grid->cols = (map_width + cell_width - 1) / cell_width;
+  grid->rows = (map_height + cell_height - 1) / cell_height;
+
+  if (areas.size() > AREA_GRID_MAX_ENTRIES) {
+    return false;
+  }
+
+  const int num_cells = grid->cols * grid->rows;
+  std::vector<int> counts(num_cells + 1, 0);
+
+  // First pass counts the areas per cell, second pass scatters the indices
+  for (int pass = 0; pass < 2; pass++) {
+    for (unsigned int i = 0; i < areas.size(); i++) {
+      const area_rect &area = areas[i];
+      if (area.width <= 0 || area.height <= 0) {
+        continue;
+      }
+
+      int x0 = clamp_cell(area.x / cell_width, grid->cols - 1);
+      int y0 = clamp_cell(area.y / cell_height, grid->rows - 1);
+      int x1 = clamp_cell((area.x + area.width - 1) / cell_width, grid->cols - 1);
+      int y1 = clamp_cell((area.y + area.height - 1) / cell_height, grid->rows - 1);
+
+      for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+          const int cell = y * grid->cols + x;
+          if (pass == 0) {
+            counts[cell + 1]++;
+          }
+          else {
+            grid->indices[counts[cell]++] = (unsigned short) i;
+          }
+        }
+      }
+    }
+
+    if (pass == 0) {
+      for (int cell = 0; cell < num_cells; cell++) {
+        counts[cell + 1] += counts[cell];
+      }
+
+      if (counts[num_cells] > AREA_GRID_MAX_ENTRIES) {
+        grid->offsets.clear();
+        grid->indices.clear();
+        return false;
+      }
+
+      grid->offsets.assign(counts.begin(), counts.end());
+      grid->indices.resize(counts[num_cells]);
+    }
+  }
+
+  return true;
+}
+
+int area_grid_query(const area_grid *grid, const std::vector<area_rect> &areas, int px, int py, int *result, int max_results)
+{
+  if (px < 0 || py < 0) {
+    return 0;
+  }
+
+  const int x = px / grid->cell_width;
+  const int y = py / grid->cell_height;
+  if (x >= grid->cols || y >= grid->rows) {
+    return 0;
+  }
+
+  const int cell = y * grid->cols + x;
+  int num_found = 0;
+
+  for (int i = grid->offsets[cell]; i < grid->offsets[cell + 1] && num_found < max_results; i++) {
+    const int index = grid->indices[i];
+    if (area_contains(areas[index], px, py)) {
+      result[num_found++] = index;
+    }
+  }
+
+  return num_found;
+}
+
+int area_list_query(const std::vector<area_rect> &areas, int px, int py, int *result, int max_results)
+{
+  int num_found = 0;
+
+  for (unsigned int i = 0; i < areas.size() && num_found < max_results; i++) {
+    if (area_contains(areas[i], px, py)) {
+      result[num_found++] = i;
+    }
+  }
+
+  return num_found;
+}
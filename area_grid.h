@@ -0,0 +1,41 @@
+#ifndef _AREA_GRID_H
+#define _AREA_GRID_H
+
+#include <vector>
+
+// Bounding rectangle of an area, in pixels
+struct area_rect
+{
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// Uniform grid mapping each cell to the areas overlapping it
+struct area_grid
+{
+  int cell_width;
+  int cell_height;
+  int cols;
+  int rows;
+
+  // Start of each cell's bucket in indices, cols * rows + 1 entries
+  std::vector<unsigned short> offsets;
+  std::vector<unsigned short> indices;
+};
+
+// Largest number of areas, and of cell entries, the 16-bit tables can address
+#define AREA_GRID_MAX_ENTRIES 0xffff
+
+// Bucket all areas into cells of cell_width x cell_height pixels.
+// Returns false when there are more areas or cell entries than AREA_GRID_MAX_ENTRIES.
+bool area_grid_build(area_grid *grid, const std::vector<area_rect> &areas, int map_width, int map_height, int cell_width, int cell_height);
+
+// Collect the indices of all areas containing pixel (px, py), returns the number found
+int area_grid_query(const area_grid *grid, const std::vector<area_rect> &areas, int px, int py, int *result, int max_results);
+
+// Reference query testing the point against every area
+int area_list_query(const std::vector<area_rect> &areas, int px, int py, int *result, int max_results);
+
+#endif
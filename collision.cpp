@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include "tile_types.h"
+#include "type_schema.h"
+#include "collision.h"
+
+char get_tile_type(const char *str)
+{
+  return (char) type_lookup(TYPE_KIND_TILE, str, TILE_TYPE_NONE);
+}
+
+int get_max_tiles(const Tmx::Tileset *tileset)
+{
+  // Without an image, rely on the tile count or the highest tile id
+  if (!tileset->GetImage()) {
+    int max_tiles = tileset->GetTileCount();
+    const std::vector<Tmx::Tile> &tiles = tileset->GetTiles();
+    for (unsigned int i = 0; i < tiles.size(); i++) {
+      if (tiles[i].GetId() >= max_tiles) {
+        max_tiles = tiles[i].GetId() + 1;
+      }
+    }
+
+    return max_tiles;
+  }
+
+  int w  = (tileset->GetImage())->GetWidth();
+  int h  = (tileset->GetImage())->GetHeight();
+
+  int tw = tileset->GetTileWidth();
+  int th = tileset->GetTileHeight();
+
+  int max_tiles_x = w / tw;
+  int max_tiles_y = h / th;
+
+  return max_tiles_x * max_tiles_y;
+}
+
+void tile_attrs_build(std::vector<tile_attr> *attrs, const Tmx::Tileset *tileset, int num_tiles)
+{
+  attrs->assign(num_tiles, tile_attr());
+
+  for (int i = 0; i < num_tiles; i++) {
+    const Tmx::Tile *tile = tileset->GetTile(i);
+    if (!tile) {
+      continue;
+    }
+
+    const Tmx::PropertySet &prop = tile->GetProperties();
+    char type = get_tile_type(prop.GetLiteralProperty(std::string("type")).c_str());
+    if (type == TILE_TYPE_OVERLAY) {
+      char bg = (char) atoi(prop.GetLiteralProperty(std::string("bg_tile")).c_str());
+      bg <<= 1;
+      type |= bg;
+    }
+
+    (*attrs)[i].type = type;
+    (*attrs)[i].mask = strtol(prop.GetLiteralProperty(std::string("mask")).c_str(), NULL, 16);
+  }
+}
+
+void collision_build(collision_map *cmap, const std::vector<const Tmx::Layer *> &layers, const std::vector<tile_attr> &attrs)
+{
+  const Tmx::Layer *base = layers[0];
+
+  cmap->width = base->GetWidth();
+  cmap->height = base->GetHeight();
+  cmap->cells.assign(cmap->width * cmap->height, 0);
+
+  const int num_attrs = attrs.size();
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    const Tmx::Layer *layer = layers[i];
+
+    for (int y = 0; y < cmap->height; y++) {
+      unsigned short *row = &cmap->cells[y * cmap->width];
+
+      for (int x = 0; x < cmap->width; x++) {
+        if (layer->GetTileTilesetIndex(x, y) < 0) {
+          continue;
+        }
+
+        const int id = layer->GetTileId(x, y);
+        if (id < num_attrs) {
+          row[x] |= (unsigned short) attrs[id].mask;
+        }
+      }
+    }
+  }
+}
+
+unsigned short collision_get(const collision_map *cmap, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= cmap->width || y >= cmap->height) {
+    return 0;
+  }
+
+  return cmap->cells[y * cmap->width + x];
+}
+
+unsigned short collision_probe(const collision_map *cmap, int px, int py, int tile_width, int tile_height)
+{
+  if (px < 0 || py < 0) {
+    return 0;
+  }
+
+  return collision_get(cmap, px / tile_width, py / tile_height);
+}
+
+void collision_solid(std::vector<unsigned char> *solid, const std::vector<const Tmx::Layer *> &layers,
+                     const std::vector<tile_attr> &attrs, int width, int height)
+{
+  solid->assign(width * height, 0);
+
+  const int num_attrs = attrs.size();
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    const Tmx::Layer *layer = layers[i];
+
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        if (layer->GetTileTilesetIndex(x, y) < 0) {
+          continue;
+        }
+
+        const int id = layer->GetTileId(x, y);
+        if (id < num_attrs && (attrs[id].type == TILE_TYPE_ROCK || attrs[id].type == TILE_TYPE_METAL)) {
+          (*solid)[y * width + x] = 1;
+        }
+      }
+    }
+  }
+}
+
+unsigned short collision_lookup(const std::vector<const Tmx::Layer *> &layers, const std::vector<tile_attr> &attrs, int x, int y)
+{
+  unsigned short mask = 0;
+
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    const Tmx::Layer *layer = layers[i];
+    if (x < 0 || y < 0 || x >= layer->GetWidth() || y >= layer->GetHeight()) {
+      continue;
+    }
+
+    if (layer->GetTileTilesetIndex(x, y) < 0) {
+      continue;
+    }
+
+    const unsigned id = layer->GetTileId(x, y);
+    if (id < attrs.size()) {
+      mask |= (unsigned short) attrs[id].mask;
+    }
+  }
+
+  return mask;
+}
@@ -0,0 +1,47 @@
+#ifndef _COLLISION_H
+#define _COLLISION_H
+
+#include <vector>
+#include "Tmx.h"
+
+// Attributes of a single tile as written to the tile table
+struct tile_attr
+{
+  char type;
+  short mask;
+};
+
+// Get the tile type of a type property value, TILE_TYPE_NONE if unknown
+char get_tile_type(const char *str);
+
+// Get the number of tiles of a tileset, from its image or else from its tiles
+int get_max_tiles(const Tmx::Tileset *tileset);
+
+// Read the type, background tile of overlays and mask of the first num_tiles tiles of a tileset
+void tile_attrs_build(std::vector<tile_attr> *attrs, const Tmx::Tileset *tileset, int num_tiles);
+
+// Per-cell collision masks baked from all layers of a map
+struct collision_map
+{
+  int width;
+  int height;
+  std::vector<unsigned short> cells;
+};
+
+// Combine the masks of all non-empty tiles in every layer into one mask per cell
+void collision_build(collision_map *cmap, const std::vector<const Tmx::Layer *> &layers, const std::vector<tile_attr> &attrs);
+
+// Get the baked mask of the cell at tile coordinate (x, y), zero outside the map
+unsigned short collision_get(const collision_map *cmap, int x, int y);
+
+// Get the mask of the cell at pixel coordinate (px, py)
+unsigned short collision_probe(const collision_map *cmap, int px, int py, int tile_width, int tile_height);
+
+// Mark the cells holding a rock or metal tile in any layer, the tiles that block light and movement
+void collision_solid(std::vector<unsigned char> *solid, const std::vector<const Tmx::Layer *> &layers,
+                     const std::vector<tile_attr> &attrs, int width, int height);
+
+// Resolve the mask of a cell the way the game does, through tile id to mask lookups per layer
+unsigned short collision_lookup(const std::vector<const Tmx::Layer *> &layers, const std::vector<tile_attr> &attrs, int x, int y);
+
+#endif
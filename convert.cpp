@@ -0,0 +1,1304 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fnmatch.h>
+#include "tile_types.h"
+#include "level_types.h"
+#include "collision.h"
+#include "area_grid.h"
+#include "spawn_strips.h"
+#include "path_codec.h"
+#include "tile_stats.h"
+#include "flatten.h"
+#include "crop.h"
+#include "anim_table.h"
+#include "lightmap.h"
+#include "nav_grid.h"
+#include "pvs.h"
+#include "convex.h"
+#include "type_schema.h"
+#include "convert.h"
+
+// Groups polygons are exported from
+enum polygon_group
+{
+  POLYGON_GROUP_OBJECTS,
+  POLYGON_GROUP_AREAS
+};
+
+// Polygon of an object or an area, in pixels from the top left of the level
+struct polygon_shape
+{
+  int group;
+  int index;
+  std::vector<Tmx::Point> points;
+};
+
+// Sample points per side used to check the convex pieces of a polygon
+#define POLYGON_CHECK_SAMPLES 32
+
+void convert_printf(convert_log *log, const char *format, ...)
+{
+  if (!log || !log->write) {
+    return;
+  }
+
+  char text[1024];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+
+  log->write(text, log->user);
+}
+
+// Warn about a name missing from the type schema, empty names are left unset on purpose
+static void check_type_name(enum type_kind kind, const std::string &name, const char *owner, int index, convert_log *log)
+{
+  if (!name.empty() && !type_known(kind, name.c_str())) {
+    convert_printf(log, "warning: unknown %s \"%s\" of %s %d\n", type_kind_name(kind), name.c_str(), owner, index);
+  }
+}
+
+// Lay out the sections as the whole level file
+static void write_level(const std::vector<lev_section> &sections, bool container, lev_buffer *out, convert_log *log)
+{
+  if (container) {
+    convert_printf(log, "Writing %d section(s) to container\n", (int) sections.size());
+    lev_build_container(sections, out);
+  }
+  else {
+    lev_build_stream(sections, out);
+  }
+}
+
+static void write_collision(const collision_map *cmap, int bits, bool vertical, lev_buffer *buf)
+{
+  const int outer = vertical ? cmap->width : cmap->height;
+  const int inner = vertical ? cmap->height : cmap->width;
+
+  for (int i = 0; i < outer; i++) {
+    unsigned char packed = 0;
+
+    for (int j = 0; j < inner; j++) {
+      unsigned short mask = vertical ? collision_get(cmap, i, j) : collision_get(cmap, j, i);
+
+      if (bits == 16) {
+        write_word((short) mask, buf);
+      }
+      else {
+        if (mask) {
+          packed |= 0x80 >> (j & 7);
+        }
+        if ((j & 7) == 7 || j == inner - 1) {
+          write_byte(packed, buf);
+          packed = 0;
+        }
+      }
+    }
+  }
+}
+
+static void write_area_grid(const area_grid *grid, lev_buffer *buf)
+{
+  write_word((short) grid->cell_width, buf);
+  write_word((short) grid->cell_height, buf);
+  write_word((short) grid->cols, buf);
+  write_word((short) grid->rows, buf);
+
+  for (unsigned int i = 0; i < grid->offsets.size(); i++) {
+    write_word((short) grid->offsets[i], buf);
+  }
+
+  for (unsigned int i = 0; i < grid->indices.size(); i++) {
+    write_word((short) grid->indices[i], buf);
+  }
+}
+
+static void write_anim_table(const anim_table *table, lev_buffer *buf)
+{
+  write_word((short) table->anims.size(), buf);
+  for (unsigned int i = 0; i < table->anims.size(); i++) {
+    const anim_entry *entry = &table->anims[i];
+    write_word((short) entry->tile, buf);
+    write_word((short) entry->first_frame, buf);
+    write_word((short) entry->num_frames, buf);
+    write_word((short) entry->first_cell, buf);
+    write_word((short) entry->num_cells, buf);
+  }
+
+  write_word((short) table->frames.size(), buf);
+  for (unsigned int i = 0; i < table->frames.size(); i++) {
+    write_word((short) table->frames[i].tile, buf);
+    write_word((short) table->frames[i].duration, buf);
+  }
+
+  write_word((short) table->cells.size(), buf);
+  for (unsigned int i = 0; i < table->cells.size(); i++) {
+    write_word((short) table->cells[i].plane, buf);
+    write_word((short) table->cells[i].x, buf);
+    write_word((short) table->cells[i].y, buf);
+  }
+}
+
+static void write_lightmap(const lightmap *lmap, bool vertical, lev_buffer *buf)
+{
+  write_word((short) lmap->width, buf);
+  write_word((short) lmap->height, buf);
+  write_word((short) lmap->subdiv, buf);
+
+  const int outer = vertical ? lmap->width : lmap->height;
+  const int inner = vertical ? lmap->height : lmap->width;
+  for (int i = 0; i < outer; i++) {
+    for (int j = 0; j < inner; j++) {
+      write_byte(vertical ? lightmap_get(lmap, i, j) : lightmap_get(lmap, j, i), buf);
+    }
+  }
+}
+
+static void write_nav_grid(const nav_grid *grid, const std::vector<nav_target> &targets, bool flow_fields, bool vertical, lev_buffer *buf)
+{
+  const int outer = vertical ? grid->width : grid->height;
+  const int inner = vertical ? grid->height : grid->width;
+
+  write_word((short) grid->width, buf);
+  write_word((short) grid->height, buf);
+
+  for (int i = 0; i < outer; i++) {
+    unsigned char packed = 0;
+
+    for (int j = 0; j < inner; j++) {
+      if (vertical ? nav_walkable(grid, i, j) : nav_walkable(grid, j, i)) {
+        packed |= 0x80 >> (j & 7);
+      }
+      if ((j & 7) == 7 || j == inner - 1) {
+        write_byte(packed, buf);
+        packed = 0;
+      }
+    }
+  }
+
+  // The flag promises a target count, even when there are no targets
+  if (!flow_fields) {
+    return;
+  }
+
+  write_word((short) targets.size(), buf);
+  for (unsigned int f = 0; f < targets.size(); f++) {
+    const nav_target *target = &targets[f];
+    write_word((short) target->kind, buf);
+    write_word((short) target->index, buf);
+    write_word((short) target->x, buf);
+    write_word((short) target->y, buf);
+    write_word((short) target->width, buf);
+    write_word((short) target->height, buf);
+
+    // Two cells per byte, the first one in the high nibble
+    for (int i = 0; i < outer; i++) {
+      for (int j = 0; j < inner; j += 2) {
+        int high = vertical ? nav_direction(grid, f, i, j) : nav_direction(grid, f, j, i);
+        int low = NAV_NO_DIRECTION;
+        if (j + 1 < inner) {
+          low = vertical ? nav_direction(grid, f, i, j + 1) : nav_direction(grid, f, j + 1, i);
+        }
+        write_byte((high << 4) | low, buf);
+      }
+    }
+  }
+}
+
+static void write_pvs(const pvs_table *pvs, bool vertical, lev_buffer *buf)
+{
+  write_word((short) pvs->region_width, buf);
+  write_word((short) pvs->region_height, buf);
+  write_word((short) pvs->cols, buf);
+  write_word((short) pvs->rows, buf);
+  write_word((short) pvs->num_objects, buf);
+
+  const int outer = vertical ? pvs->cols : pvs->rows;
+  const int inner = vertical ? pvs->rows : pvs->cols;
+  for (int i = 0; i < outer; i++) {
+    for (int j = 0; j < inner; j++) {
+      const int col = vertical ? i : j;
+      const int row = vertical ? j : i;
+      write_word((short) pvs_region_mask(pvs, col, row), buf);
+
+      const unsigned char *bits = pvs_region_objects(pvs, col, row);
+      for (int k = 0; k < pvs->object_bytes; k++) {
+        write_byte(bits[k], buf);
+      }
+    }
+  }
+}
+
+static void write_box(const convex_box *box, lev_buffer *buf)
+{
+  write_word((short) box->x0, buf);
+  write_word((short) box->y0, buf);
+  write_word((short) box->x1, buf);
+  write_word((short) box->y1, buf);
+}
+
+// Split every polygon into checked convex pieces and write them, fails on the first bad polygon
+static bool write_polygons(const std::vector<polygon_shape> &shapes, lev_buffer *buf, convert_log *log)
+{
+  write_word((short) shapes.size(), buf);
+
+  for (unsigned int i = 0; i < shapes.size(); i++) {
+    const polygon_shape *shape = &shapes[i];
+    const char *group_name = shape->group == POLYGON_GROUP_AREAS ? "areas" : "objects";
+
+    std::vector<convex_piece> pieces;
+    if (!convex_decompose(&pieces, shape->points)) {
+      convert_printf(log, "error: polygon of %s %d is degenerate or crosses itself\n", group_name, shape->index);
+      return false;
+    }
+
+    const int mismatches = convex_check(pieces, shape->points, POLYGON_CHECK_SAMPLES);
+    if (mismatches) {
+      convert_printf(log, "error: convex pieces of polygon of %s %d differ from it at %d sample point(s)\n", group_name, shape->index, mismatches);
+      return false;
+    }
+
+    convert_printf(log, "Polygon of %s %d: %d point(s) in %d convex piece(s)\n", group_name, shape->index, (int) shape->points.size(), (int) pieces.size());
+
+    convex_box box;
+    convex_bounds(&box, shape->points);
+    write_word((short) shape->group, buf);
+    write_word((short) shape->index, buf);
+    write_box(&box, buf);
+    write_word((short) pieces.size(), buf);
+
+    for (unsigned int j = 0; j < pieces.size(); j++) {
+      const convex_piece *piece = &pieces[j];
+      write_word((short) piece->points.size(), buf);
+      write_box(&piece->box, buf);
+
+      for (unsigned int k = 0; k < piece->points.size(); k++) {
+        write_word((short) piece->points[k].x, buf);
+        write_word((short) piece->points[k].y, buf);
+      }
+      for (unsigned int k = 0; k < piece->normals.size(); k++) {
+        write_word((short) piece->normals[k].x, buf);
+        write_word((short) piece->normals[k].y, buf);
+      }
+    }
+  }
+
+  return true;
+}
+
+// Write a tile id as a byte or a word
+static void write_tile(unsigned id, int size, lev_buffer *buf)
+{
+  if (size == 2) {
+    write_word((short) id, buf);
+  }
+  else {
+    write_byte((char) id, buf);
+  }
+}
+
+// Collect the layers named in a comma separated list, or all layers without a list
+static bool select_layers(std::vector<const Tmx::Layer *> *layers, const Tmx::Map *map, const char *names, convert_log *log)
+{
+  if (!names) {
+    for (int i = 0; i < map->GetNumLayers(); i++) {
+      layers->push_back(map->GetLayer(i));
+    }
+    return true;
+  }
+
+  while (*names) {
+    const char *end = strchr(names, ',');
+    if (!end) {
+      end = names + strlen(names);
+    }
+
+    const std::string name(names, end);
+    const Tmx::Layer *layer = map->FindLayer(name);
+    if (!layer) {
+      convert_printf(log, "error: no layer named %s\n", name.c_str());
+      return false;
+    }
+
+    layers->push_back(layer);
+    names = *end ? end + 1 : end;
+  }
+
+  return true;
+}
+
+void convert_options_init(convert_options *opts)
+{
+  opts->data_size = 2;
+  opts->auto_size = false;
+  opts->verbose = false;
+  opts->vertical = false;
+  opts->legacy = false;
+  opts->bottom = false;
+  opts->collision_bits = 0;
+  opts->area_grid_tiles = 0;
+  opts->strip_size = 0;
+  opts->container = false;
+  opts->compact_paths = false;
+  opts->chunks = false;
+  opts->cache_name = NULL;
+  opts->layer_names = NULL;
+  opts->tileset_name = NULL;
+  opts->objects_name = "objects";
+  opts->areas_name = "areas";
+  opts->flatten_pattern = NULL;
+  opts->crop = false;
+  opts->spans = false;
+  opts->animations = false;
+  opts->light_subdiv = 0;
+  opts->nav = false;
+  opts->flow_fields = false;
+  opts->pvs_width = 0;
+  opts->pvs_height = 0;
+  opts->polygons = false;
+}
+
+bool convert_parse_options(convert_options *opts, int count, const char *const *args, convert_log *log)
+{
+  for (int i = 0; i < count; i++) {
+    if (strcmp(args[i], "--datasize") == 0 && i + 1 < count && strcmp(args[i + 1], "auto") == 0) {
+      opts->auto_size = true;
+      i++;
+    }
+    else if (strcmp(args[i], "--datasize") == 0 && i + 1 < count) {
+      opts->data_size = atoi(args[i + 1]);
+      if (opts->data_size < 1) {
+        opts->data_size = 1;
+      }
+      else if (opts->data_size > 2) {
+        opts->data_size = 2;
+      }
+      i++;
+    }
+    else if (strcmp(args[i], "--verbose") == 0) {
+      opts->verbose = true;
+    }
+    else if (strcmp(args[i], "--vertical") == 0) {
+      opts->vertical = true;
+    }
+    else if (strcmp(args[i], "--legacy") == 0) {
+      opts->legacy = true;
+    }
+    else if (strcmp(args[i], "--bottom") == 0) {
+      opts->bottom = true;
+    }
+    else if (strcmp(args[i], "--collision") == 0 && i + 1 < count) {
+      opts->collision_bits = atoi(args[i + 1]);
+      if (opts->collision_bits != 1 && opts->collision_bits != 16) {
+        convert_printf(log, "error: collision bits must be 1 or 16, not %s\n", args[i + 1]);
+        return false;
+      }
+      i++;
+    }
+    else if (strcmp(args[i], "--area-grid") == 0 && i + 1 < count) {
+      opts->area_grid_tiles = atoi(args[i + 1]);
+      if (opts->area_grid_tiles < 1) {
+        opts->area_grid_tiles = 1;
+      }
+      i++;
+    }
+    else if (strcmp(args[i], "--container") == 0) {
+      opts->container = true;
+    }
+    else if (strcmp(args[i], "--compact-paths") == 0) {
+      opts->compact_paths = true;
+    }
+    else if (strcmp(args[i], "--chunks") == 0) {
+      opts->chunks = true;
+    }
+    else if (strcmp(args[i], "--layers") == 0 && i + 1 < count) {
+      opts->layer_names = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--tileset") == 0 && i + 1 < count) {
+      opts->tileset_name = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--objects") == 0 && i + 1 < count) {
+      opts->objects_name = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--areas") == 0 && i + 1 < count) {
+      opts->areas_name = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--crop") == 0) {
+      opts->crop = true;
+    }
+    else if (strcmp(args[i], "--spans") == 0) {
+      opts->crop = true;
+      opts->spans = true;
+    }
+    else if (strcmp(args[i], "--animations") == 0) {
+      opts->animations = true;
+    }
+    else if (strcmp(args[i], "--lightmap") == 0 && i + 1 < count) {
+      opts->light_subdiv = atoi(args[i + 1]);
+      if (opts->light_subdiv < 1 || opts->light_subdiv > 8) {
+        convert_printf(log, "error: lightmap cells per tile must be 1 to 8, not %s\n", args[i + 1]);
+        return false;
+      }
+      i++;
+    }
+    else if (strcmp(args[i], "--nav") == 0) {
+      opts->nav = true;
+    }
+    else if (strcmp(args[i], "--flow-fields") == 0) {
+      opts->nav = true;
+      opts->flow_fields = true;
+    }
+    else if (strcmp(args[i], "--pvs") == 0 && i + 1 < count) {
+      if (sscanf(args[i + 1], "%dx%d", &opts->pvs_width, &opts->pvs_height) != 2 || opts->pvs_width < 1 || opts->pvs_height < 1) {
+        convert_printf(log, "error: region size must be given as <width>x<height> pixels\n");
+        return false;
+      }
+      i++;
+    }
+    else if (strcmp(args[i], "--polygons") == 0) {
+      opts->polygons = true;
+    }
+    else if (strcmp(args[i], "--flatten") == 0 && i + 1 < count) {
+      opts->flatten_pattern = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--cache") == 0 && i + 1 < count) {
+      opts->cache_name = args[i + 1];
+      i++;
+    }
+    else if (strcmp(args[i], "--strips") == 0 && i + 1 < count) {
+      opts->strip_size = atoi(args[i + 1]);
+      if (opts->strip_size < 1) {
+        opts->strip_size = 1;
+      }
+      i++;
+    }
+    else {
+      convert_printf(log, "error: %s is not an option or lacks its value\n", args[i]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int convert_level(const Tmx::Map *map, const convert_options *opts, lev_buffer *out, convert_log *log)
+{
+  // data_size is widened below when the tile size is picked per layer
+  int data_size = opts->data_size;
+  const bool auto_size = opts->auto_size;
+  const bool verbose = opts->verbose;
+  const bool vertical = opts->vertical;
+  const bool legacy = opts->legacy;
+  const bool bottom = opts->bottom;
+  const int collision_bits = opts->collision_bits;
+  const int area_grid_tiles = opts->area_grid_tiles;
+  const int strip_size = opts->strip_size;
+  const bool container = opts->container;
+  const bool compact_paths = opts->compact_paths;
+  const bool chunks = opts->chunks;
+  const char *layer_names = opts->layer_names;
+  const char *tileset_name = opts->tileset_name;
+  const char *objects_name = opts->objects_name;
+  const char *areas_name = opts->areas_name;
+  const char *flatten_pattern = opts->flatten_pattern;
+  bool crop = opts->crop;
+  bool spans = opts->spans;
+  const bool animations = opts->animations;
+  const int light_subdiv = opts->light_subdiv;
+  const bool nav = opts->nav;
+  const bool flow_fields = opts->flow_fields;
+  const int pvs_width = opts->pvs_width;
+  const int pvs_height = opts->pvs_height;
+  const bool polygons = opts->polygons;
+
+  convert_printf(log, "Version: %1.1f\n", map->GetVersion());
+
+  const int failed_kind = type_schema_failed_kind();
+  if (failed_kind >= 0) {
+    convert_printf(log, "error: no perfect hash found for the %s names of level_types.def\n", type_kind_name((enum type_kind) failed_kind));
+    return 1;
+  }
+
+  if (map->GetOrientation() != Tmx::TMX_MO_ORTHOGONAL) {
+    convert_printf(log, "error: map orientation must be orthogonal\n");
+    return 1;
+  }
+
+  std::vector<lev_section> sections;
+  lev_buffer tile_buf;
+  lev_buffer layer_buf;
+  lev_buffer object_buf;
+  lev_buffer area_buf;
+  lev_buffer collision_buf;
+  lev_buffer grid_buf;
+  lev_buffer strip_buf;
+  lev_buffer anim_buf;
+  lev_buffer light_buf;
+  lev_buffer nav_buf;
+  lev_buffer pvs_buf;
+  lev_buffer poly_buf;
+
+  if (map->GetNumTilesets() <= 0) {
+    convert_printf(log, "error - no tileset exist\n");
+    return 1;
+  }
+
+  const Tmx::Tileset *tileset = tileset_name ? map->FindTileset(std::string(tileset_name)) : map->GetTileset(0);
+  if (!tileset) {
+    convert_printf(log, "error: no tileset named %s\n", tileset_name);
+    return 1;
+  }
+
+  if (!tileset->GetSource().empty()) {
+    convert_printf(log, "Tileset: %s\n", tileset->GetSource().c_str());
+    if (tileset->GetTileWidth() == 0) {
+      convert_printf(log, "error: unable to load tileset %s\n", tileset->GetSource().c_str());
+      return 1;
+    }
+  }
+
+  int num_tiles = get_max_tiles(tileset);
+  convert_printf(log, "Number of tiles: %d\n", num_tiles);
+
+  std::vector<const Tmx::Layer *> layers;
+  if (!select_layers(&layers, map, layer_names, log)) {
+    return 1;
+  }
+
+  // Find the smallest tile size of every layer, ids that do not fit are an error
+  std::vector<tile_stats> stats(layers.size());
+  std::vector<int> layer_sizes(layers.size(), data_size);
+  if (auto_size) {
+    data_size = num_tiles <= 0xff ? 1 : 2;
+  }
+
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    const Tmx::Layer *layer = layers[i];
+    tile_stats_build(&stats[i], layer, layer->GetWidth(), layer->GetHeight());
+
+    const int size = tile_stats_data_size(&stats[i]);
+    if (size == 0 || (!auto_size && size > data_size)) {
+      convert_printf(log, "error: layer %d has tile id %u, which does not fit in %d byte(s)\n", i, stats[i].max_id, size ? data_size : 2);
+      return 1;
+    }
+
+    if (auto_size) {
+      layer_sizes[i] = size;
+      if (size > data_size) {
+        data_size = size;
+      }
+    }
+
+    if (verbose) {
+      convert_printf(log, "Layer %d/%d statistics: ", i + 1, (int) layers.size());
+      std::string text;
+      tile_stats_format(&stats[i], &text);
+      convert_printf(log, "%s", text.c_str());
+    }
+  }
+
+  if (data_size == 2) {
+    convert_printf(log, "2-byte per tile\n");
+    if (!legacy) {
+      write_word((short) num_tiles, &tile_buf);
+    }
+  }
+  else {
+    convert_printf(log, "1-byte per tile\n");
+    if (!legacy) {
+      write_byte((char) num_tiles, &tile_buf);
+    }
+  }
+
+  if (!legacy) {
+    lev_section section = { LEV_SECTION_TILES, (unsigned short) (data_size == 1 ? LEV_FLAG_BYTE_TILES : 0), &tile_buf };
+    sections.push_back(section);
+  }
+
+  std::vector<tile_attr> attrs;
+  tile_attrs_build(&attrs, tileset, num_tiles);
+
+  for (int i = 0; i < num_tiles; i++) {
+    const Tmx::Tile *tile = tileset->GetTile(i);
+    if (tile && attrs[i].type == TILE_TYPE_NONE && tile->GetProperties().HasProperty(std::string("type"))) {
+      check_type_name(TYPE_KIND_TILE, tile->GetProperties().GetLiteralProperty(std::string("type")), "tile", i, log);
+    }
+  }
+
+  const std::vector<Tmx::Tile> &tiles = tileset->GetTiles();
+  if (!legacy) {
+    for (int i = 0; i < num_tiles; i++) {
+      const Tmx::Tile *tile = tileset->GetTile(i);
+      if (tile) {
+        const Tmx::PropertySet &prop = tile->GetProperties();
+        convert_printf(log, "tile: %d %s(0x%x) %s(0x%x)\n", i, prop.GetLiteralProperty(std::string("type")).c_str(), attrs[i].type & 0xFF,
+               prop.GetLiteralProperty(std::string("mask")).c_str(), attrs[i].mask & 0xFFFF);
+      }
+
+      write_byte(attrs[i].type, &tile_buf);
+      write_word(attrs[i].mask, &tile_buf);
+    }
+  }
+
+  const int num_layers = layers.size();
+  if (num_layers <= 0) {
+    convert_printf(log, "error: no layers exist\n");
+    return 1;
+  }
+
+  const Tmx::Layer *layer = layers[0];
+
+  short w = (short) layer->GetWidth();
+  short h = (short) layer->GetHeight();
+
+  convert_printf(log, "Map size: %dx%d\n", w, h);
+
+  // Infinite maps are cropped, so object positions are moved along with the tiles
+  const int x_shift = layer->GetOriginX() * map->GetTileWidth();
+  const int y_shift = layer->GetOriginY() * map->GetTileHeight();
+  if (map->IsInfinite()) {
+    convert_printf(log, "Infinite map cropped at: (%d, %d)\n", layer->GetOriginX(), layer->GetOriginY());
+  }
+
+  // Layers matching the pattern or with the flatten property may be composited into fewer planes
+  std::vector<bool> candidates(num_layers, false);
+  bool flatten = false;
+  for (int i = 0; i < num_layers; i++) {
+    const Tmx::Layer *layer = layers[i];
+    candidates[i] = (flatten_pattern && fnmatch(flatten_pattern, layer->GetName().c_str(), 0) == 0) ||
+                    layer->GetProperties().GetNumericProperty("flatten") != 0;
+    flatten = flatten || candidates[i];
+  }
+
+  // The layer flag and every plane must agree on whether planes are stored as chunks
+  const bool chunked = chunks && map->IsInfinite();
+
+  if (flatten && chunked) {
+    convert_printf(log, "Chunked layers are not flattened\n");
+    flatten = false;
+  }
+
+  // Chunks are written with their own bounds, without a crop box or span table
+  if (crop && chunked) {
+    convert_printf(log, "Chunked layers are not cropped\n");
+    crop = false;
+    spans = false;
+  }
+
+  std::vector<plane> planes;
+  if (flatten) {
+    flatten_layers(&planes, layers, candidates, attrs, w, h);
+  }
+  else {
+    for (int i = 0; i < num_layers; i++) {
+      planes.push_back(plane());
+      planes.back().layers.push_back(i);
+    }
+  }
+
+  const int num_planes = planes.size();
+  if (flatten) {
+    // Bytes of the layers of every merged plane written one by one, cropped as they would be,
+    // less the bytes of the plane
+    int saved = 0;
+    for (int i = 0; i < num_planes; i++) {
+      const plane *p = &planes[i];
+      if (p->layers.size() < 2) {
+        continue;
+      }
+
+      int layer_size = 1;
+      for (unsigned int j = 0; j < p->layers.size(); j++) {
+        plane single;
+        single.layers.push_back(p->layers[j]);
+        saved += crop_plane_bytes(&single, layers, w, h, layer_sizes[p->layers[j]], crop, spans, vertical) + (auto_size ? 1 : 0);
+        layer_size = layer_sizes[p->layers[j]] > layer_size ? layer_sizes[p->layers[j]] : layer_size;
+      }
+      saved -= crop_plane_bytes(p, layers, w, h, layer_size, crop, spans, vertical) + (auto_size ? 1 : 0);
+    }
+    convert_printf(log, "Flattened %d layer(s) into %d plane(s), %d plane(s) and %d byte(s) eliminated\n",
+           num_layers, num_planes, num_layers - num_planes, saved);
+  }
+
+  write_word(w, &layer_buf);
+  write_word(h, &layer_buf);
+
+  for (int i = 0; i < num_planes; i++) {
+
+    const plane *p = &planes[i];
+    const Tmx::Layer *layer = layers[p->layers[0]];
+    convert_printf(log, "Layer %d/%d: %s", i + 1, num_planes, layer->GetName().c_str());
+    for (unsigned int j = 1; j < p->layers.size(); j++) {
+      convert_printf(log, " + %s", layers[p->layers[j]]->GetName().c_str());
+    }
+    convert_printf(log, "\n");
+
+    // A plane needs the widest tile size of its layers
+    int layer_size = 1;
+    for (unsigned int j = 0; j < p->layers.size(); j++) {
+      if (layer_sizes[p->layers[j]] > layer_size) {
+        layer_size = layer_sizes[p->layers[j]];
+      }
+    }
+
+    if (auto_size) {
+      convert_printf(log, "%d-byte per tile\n", layer_size);
+      write_byte((char) layer_size, &layer_buf);
+    }
+
+    if (chunked && layer->IsChunked()) {
+      write_word((short) layer->GetNumChunks(), &layer_buf);
+      convert_printf(log, "%d chunk(s)\n", layer->GetNumChunks());
+
+      for (int c = 0; c < layer->GetNumChunks(); c++) {
+        const Tmx::LayerChunk &chunk = layer->GetChunk(c);
+        const int chunk_x = chunk.x - layer->GetOriginX();
+        const int chunk_y = chunk.y - layer->GetOriginY();
+
+        write_word((short) chunk_x, &layer_buf);
+        write_word((short) chunk_y, &layer_buf);
+        write_word((short) chunk.width, &layer_buf);
+        write_word((short) chunk.height, &layer_buf);
+
+        const int outer = vertical ? chunk.width : chunk.height;
+        const int inner = vertical ? chunk.height : chunk.width;
+        for (int o = 0; o < outer; o++) {
+          for (int n = 0; n < inner; n++) {
+            const int x = vertical ? o : n;
+            const int y = vertical ? n : o;
+            write_tile(chunk.tiles[y * chunk.width + x].id, layer_size, &layer_buf);
+          }
+        }
+      }
+    }
+    else if (chunked) {
+      // A layer of an infinite map without chunks, such as an empty one, becomes a single
+      // chunk holding its tiles, or no chunk at all when it has none
+      const int chunk_width = layer->GetWidth() < w ? layer->GetWidth() : w;
+      const int chunk_height = layer->GetHeight() < h ? layer->GetHeight() : h;
+      bool empty = true;
+      for (int y = 0; empty && y < chunk_height; y++) {
+        for (int x = 0; empty && x < chunk_width; x++) {
+          empty = plane_tile_empty(p, layers, w, x, y);
+        }
+      }
+
+      write_word((short) (empty ? 0 : 1), &layer_buf);
+      convert_printf(log, "%d chunk(s)\n", empty ? 0 : 1);
+
+      if (!empty) {
+        write_word(0, &layer_buf);
+        write_word(0, &layer_buf);
+        write_word((short) chunk_width, &layer_buf);
+        write_word((short) chunk_height, &layer_buf);
+
+        const int outer = vertical ? chunk_width : chunk_height;
+        const int inner = vertical ? chunk_height : chunk_width;
+        for (int o = 0; o < outer; o++) {
+          for (int n = 0; n < inner; n++) {
+            const int x = vertical ? o : n;
+            const int y = vertical ? n : o;
+            write_tile(plane_tile_id(p, layers, w, x, y), layer_size, &layer_buf);
+          }
+        }
+      }
+    }
+    else {
+      // Without cropping the box is the whole map
+      crop_box box = { 0, 0, w, h };
+      if (crop) {
+        crop_bounds(&box, p, layers, w, h);
+        write_word((short) box.x, &layer_buf);
+        write_word((short) box.y, &layer_buf);
+        write_word((short) box.width, &layer_buf);
+        write_word((short) box.height, &layer_buf);
+        convert_printf(log, "cropped to %dx%d at (%d, %d)\n", box.width, box.height, box.x, box.y);
+      }
+
+      const int outer = vertical ? box.width : box.height;
+      const int inner = vertical ? box.height : box.width;
+
+      // Every row, or column when vertical, only keeps its span of non-empty cells
+      std::vector<crop_span> line_spans;
+      if (spans) {
+        crop_spans(&line_spans, &box, p, layers, w, vertical);
+        for (int o = 0; o < outer; o++) {
+          write_word((short) line_spans[o].first, &layer_buf);
+          write_word((short) line_spans[o].count, &layer_buf);
+        }
+      }
+
+      for (int o = 0; o < outer; o++) {
+        const int first = spans ? line_spans[o].first : 0;
+        const int count = spans ? line_spans[o].count : inner;
+
+        for (int n = first; n < first + count; n++) {
+          const int x = box.x + (vertical ? o : n);
+          const int y = box.y + (vertical ? n : o);
+          write_tile(plane_tile_id(p, layers, w, x, y), layer_size, &layer_buf);
+        }
+      }
+    }
+  }
+
+  unsigned short layer_flags = vertical ? LEV_FLAG_VERTICAL : 0;
+  if (data_size == 1) {
+    layer_flags |= LEV_FLAG_BYTE_TILES;
+  }
+  if (auto_size) {
+    layer_flags |= LEV_FLAG_LAYER_SIZES;
+  }
+  if (crop) {
+    layer_flags |= LEV_FLAG_CROPPED;
+  }
+  if (spans) {
+    layer_flags |= LEV_FLAG_SPANS;
+  }
+  if (chunked) {
+    layer_flags |= LEV_FLAG_CHUNKED;
+  }
+  lev_section layer_section = { LEV_SECTION_LAYERS, layer_flags, &layer_buf };
+  sections.push_back(layer_section);
+
+  if (legacy) {
+    write_level(sections, container, out, log);
+    return 0;
+  }
+
+  std::vector<area_rect> areas;
+  std::vector<spawn_strip> strips;
+  std::vector<light_source> lights;
+  std::vector<nav_target> targets;
+  std::vector<pvs_object> pvs_objects;
+  std::vector<polygon_shape> shapes;
+
+  const int num_groups = map->GetNumObjectGroups();
+  if (num_groups > 0)
+  {
+    convert_printf(log, "Found %d object group(s)\n", num_groups);
+
+    const int objects_index = map->FindObjectGroupIndex(objects_name);
+
+    if (objects_index >= 0)
+    {
+      const Tmx::ObjectGroup *group = map->GetObjectGroup(objects_index);
+      const int num_objects = group->GetNumObjects();
+
+      if (num_objects > 0)
+      {
+        convert_printf(log, "%s has %d object(s)\n", group->GetName().c_str(), num_objects);
+        write_word((short) num_objects, &object_buf);
+
+        // Position of each object along the scroll axis
+        std::vector<int> positions(num_objects);
+        for (int j = 0; j < num_objects; j++)
+        {
+          const Tmx::Object *object = group->GetObject(j);
+          if (!vertical)
+          {
+            positions[j] = object->GetX() - x_shift;
+          }
+          else if (!bottom)
+          {
+            positions[j] = object->GetY() - y_shift;
+          }
+          else
+          {
+            positions[j] = object->GetY() + object->GetHeight() - y_shift;
+          }
+        }
+
+        std::vector<int> order;
+        spawn_sort(&order, positions);
+        if (strip_size)
+        {
+          int extent = vertical ? h * map->GetTileHeight() : w * map->GetTileWidth();
+          spawn_strips_build(&strips, order, positions, strip_size, extent);
+        }
+        else
+        {
+          for (int j = 0; j < num_objects; j++)
+          {
+            order[j] = j;
+          }
+        }
+
+        for (int k = 0; k < num_objects; k++)
+        {
+          const int j = order[k];
+          const Tmx::Object *object = group->GetObject(j);
+
+          const std::string type_name = object->GetType();
+          enum object_type object_type = get_object_type(type_name.c_str());
+
+          const Tmx::PropertySet prop = object->GetProperties();
+          int index = prop.GetNumericProperty(std::string("index"));
+          std::string dir_name = prop.GetLiteralProperty(std::string("direction"));
+          int param = prop.GetNumericProperty(std::string("param"));
+          enum direction dir = get_direction(dir_name.c_str());
+
+          if (object_type == OBJECT_TYPE_UNKNOWN)
+          {
+            check_type_name(TYPE_KIND_OBJECT, type_name, "object", j, log);
+          }
+          if (dir == MAX_DIRECTION && prop.HasProperty(std::string("direction")))
+          {
+            check_type_name(TYPE_KIND_DIRECTION, dir_name, "object", j, log);
+          }
+
+          int obj_x = object->GetX() - x_shift;
+          int obj_y;
+          if (!bottom)
+          {
+            obj_y = object->GetY() - y_shift;
+          }
+          else
+          {
+            obj_y = object->GetY() + object->GetHeight() - y_shift;
+          }
+
+          convert_printf(log, "\t%s(%d) - \"%s\" index=%d at: (%d, %d), facing %d(%s), param=%d\n", type_name.c_str(), object_type, object->GetName().c_str(), index, obj_x, obj_y, dir, dir_name.c_str(), param);
+
+          write_byte((char) object_type, &object_buf);
+          write_byte((char) index, &object_buf);
+          write_byte((char) dir, &object_buf);
+          write_byte((char) param, &object_buf);
+          write_word((short) obj_x, &object_buf);
+          write_word((short) obj_y, &object_buf);
+
+          pvs_object pvs_obj = { (object->GetX() - x_shift) / map->GetTileWidth(), (object->GetY() - y_shift) / map->GetTileHeight() };
+          pvs_objects.push_back(pvs_obj);
+
+          const Tmx::Polygon *polygon = object->GetPolygon();
+          if (polygon)
+          {
+            shapes.push_back(polygon_shape());
+            shapes.back().group = POLYGON_GROUP_OBJECTS;
+            shapes.back().index = k;
+            for (int p = 0; p < polygon->GetNumPoints(); p++)
+            {
+              Tmx::Point point = { object->GetX() + polygon->GetPoint(p).x - x_shift, object->GetY() + polygon->GetPoint(p).y - y_shift };
+              shapes.back().points.push_back(point);
+            }
+          }
+
+          if (object_type == OBJECT_TYPE_LIGHT)
+          {
+            light_source light = { object->GetX() + object->GetWidth() / 2 - x_shift,
+                                   object->GetY() + object->GetHeight() / 2 - y_shift, param & 0xff };
+            lights.push_back(light);
+          }
+          else if (object_type == OBJECT_TYPE_SAVETUBE)
+          {
+            nav_target target = { NAV_TARGET_SAVETUBE, k, (object->GetX() - x_shift) / map->GetTileWidth(),
+                                  (object->GetY() - y_shift) / map->GetTileHeight(), 1, 1 };
+            targets.push_back(target);
+          }
+
+          if (object_type == OBJECT_TYPE_NPC)
+          {
+            const Tmx::Polyline *polyline = object->GetPolyline();
+            if (polyline && compact_paths)
+            {
+              if (polyline->GetNumPoints() > PATH_MAX_POINTS)
+              {
+                convert_printf(log, "error: polyline of \"%s\" has %d points, at most %d fit in a compact path\n", object->GetName().c_str(), polyline->GetNumPoints(), PATH_MAX_POINTS);
+                return 1;
+              }
+
+              int size = path_encode(polyline->GetPoints(), &object_buf);
+              convert_printf(log, "Polyline[%d]: %d bytes compact\n", polyline->GetNumPoints(), size);
+            }
+            else if (polyline)
+            {
+              if (polyline->GetNumPoints() > 255)
+              {
+                convert_printf(log, "error: polyline of \"%s\" has %d points, at most 255 fit without --compact-paths\n", object->GetName().c_str(), polyline->GetNumPoints());
+                return 1;
+              }
+
+              write_byte((char) polyline->GetNumPoints(), &object_buf);
+              convert_printf(log, "Polyline[%d]: ", polyline->GetNumPoints());
+              for (int p = 0; p < polyline->GetNumPoints(); p++)
+              {
+                const Tmx::Point point = polyline->GetPoint(p);
+                write_word((short) point.x, &object_buf);
+                write_word((short) point.y, &object_buf);
+                convert_printf(log, "(%d, %d) ", point.x, point.y);
+              }
+              convert_printf(log, "\n");
+            }
+            else
+            {
+              convert_printf(log, "No polyline\n");
+              if (compact_paths)
+              {
+                write_word((short) 0, &object_buf);
+              }
+              else
+              {
+                write_byte(0, &object_buf);
+              }
+            }
+          }
+        }
+      }
+    }
+    else
+    {
+      convert_printf(log, "No objects\n");
+      write_word((short) 0, &object_buf);
+    }
+
+
+    const int areas_index = map->FindObjectGroupIndex(areas_name);
+
+    if (areas_index >= 0)
+    {
+      const Tmx::ObjectGroup *group = map->GetObjectGroup(areas_index);
+      const int num_objects = group->GetNumObjects();
+      if (num_objects > 0)
+      {
+        convert_printf(log, "%s has %d object(s)\n", group->GetName().c_str(), num_objects);
+        write_word((short) num_objects, &area_buf);
+
+        for (int j = 0; j < num_objects; j++)
+        {
+          const Tmx::Object *object = group->GetObject(j);
+
+          const std::string type_name = object->GetType();
+          enum area_type area_type = get_area_type(type_name.c_str());
+
+          const int area_x = object->GetX() - x_shift;
+          const int area_y = object->GetY() - y_shift;
+
+          const Tmx::PropertySet prop = object->GetProperties();
+          int level = prop.GetNumericProperty(std::string("level"));
+          // The start tile is in the level the door leads to, whose crop is not known here.
+          // It is kept as drawn, the world index gives it relative to that level's tiles.
+          int start_x = prop.GetNumericProperty(std::string("start_x"));
+          int start_y = prop.GetNumericProperty(std::string("start_y"));
+          std::string dir_name = prop.GetLiteralProperty(std::string("direction"));
+          enum direction dir = get_direction(dir_name.c_str());
+
+          if (area_type == AREA_TYPE_UNKNOWN)
+          {
+            check_type_name(TYPE_KIND_AREA, type_name, "area", j, log);
+          }
+          if (dir == MAX_DIRECTION && prop.HasProperty(std::string("direction")))
+          {
+            check_type_name(TYPE_KIND_DIRECTION, dir_name, "area", j, log);
+          }
+
+          convert_printf(log, "\t%s(%d) - \"%s\" at: (%d, %d) size(%d x %d), level %d, start (%d, %d), facing %d(%s)\n", type_name.c_str(), area_type, object->GetName().c_str(), area_x, area_y, object->GetWidth(), object->GetHeight(), level, start_x, start_y, dir, dir_name.c_str());
+
+          write_byte((char) area_type, &area_buf);
+          write_word((short) level, &area_buf);
+          write_word((short) start_x, &area_buf);
+          write_word((short) start_y, &area_buf);
+          write_byte((char) dir, &area_buf);
+          write_word((short) area_x, &area_buf);
+          write_word((short) area_y, &area_buf);
+          write_word((short) object->GetWidth(), &area_buf);
+          write_word((short) object->GetHeight(), &area_buf);
+
+          area_rect rect = { area_x, area_y, object->GetWidth(), object->GetHeight() };
+          areas.push_back(rect);
+
+          const Tmx::Polygon *polygon = object->GetPolygon();
+          if (polygon)
+          {
+            shapes.push_back(polygon_shape());
+            shapes.back().group = POLYGON_GROUP_AREAS;
+            shapes.back().index = j;
+            for (int p = 0; p < polygon->GetNumPoints(); p++)
+            {
+              Tmx::Point point = { area_x + polygon->GetPoint(p).x, area_y + polygon->GetPoint(p).y };
+              shapes.back().points.push_back(point);
+            }
+          }
+
+          if (area_type == AREA_TYPE_DOOR)
+          {
+            const int tile_x = area_x / map->GetTileWidth();
+            const int tile_y = area_y / map->GetTileHeight();
+            nav_target target = { NAV_TARGET_DOOR, j, tile_x, tile_y,
+                                  (area_x + object->GetWidth() - 1) / map->GetTileWidth() - tile_x + 1,
+                                  (area_y + object->GetHeight() - 1) / map->GetTileHeight() - tile_y + 1 };
+            targets.push_back(target);
+          }
+        }
+      }
+    }
+    else
+    {
+      convert_printf(log, "No areas\n");
+      write_word((short) 0, &area_buf);
+    }
+  }
+  else
+  {
+    convert_printf(log, "No object group(s) defined\n");
+    write_word((short) 0, &object_buf);
+    write_word((short) 0, &area_buf);
+  }
+
+  lev_section object_section = { LEV_SECTION_OBJECTS, (unsigned short) (compact_paths ? LEV_FLAG_COMPACT_PATHS : 0), &object_buf };
+  lev_section area_section = { LEV_SECTION_AREAS, 0, &area_buf };
+  sections.push_back(object_section);
+  sections.push_back(area_section);
+
+  if (collision_bits) {
+    collision_map cmap;
+    collision_build(&cmap, layers, attrs);
+
+    convert_printf(log, "Collision map: %dx%d, %d-bit per cell\n", cmap.width, cmap.height, collision_bits);
+    write_collision(&cmap, collision_bits, vertical, &collision_buf);
+
+    unsigned short flags = vertical ? LEV_FLAG_VERTICAL : 0;
+    if (collision_bits == 1) {
+      flags |= LEV_FLAG_PACKED;
+    }
+    lev_section section = { LEV_SECTION_COLLISION, flags, &collision_buf };
+    sections.push_back(section);
+  }
+
+  if (area_grid_tiles) {
+    area_grid grid;
+    if (!area_grid_build(&grid, areas, w * map->GetTileWidth(), h * map->GetTileHeight(),
+                         area_grid_tiles * map->GetTileWidth(), area_grid_tiles * map->GetTileHeight())) {
+      convert_printf(log, "error: area grid of %d area(s) has more than %d areas or cell entries, use larger cells\n", (int) areas.size(), AREA_GRID_MAX_ENTRIES);
+      return 1;
+    }
+
+    convert_printf(log, "Area grid: %dx%d cells of %dx%d pixels, %d entries\n", grid.cols, grid.rows, grid.cell_width, grid.cell_height, (int) grid.indices.size());
+    write_area_grid(&grid, &grid_buf);
+
+    lev_section section = { LEV_SECTION_AREA_GRID, 0, &grid_buf };
+    sections.push_back(section);
+  }
+
+  if (strip_size && strips.empty()) {
+    convert_printf(log, "Spawn strips: skipped, there are no objects in \"%s\"\n", objects_name);
+  }
+  else if (strip_size) {
+    convert_printf(log, "Spawn strips: %d of %d pixels\n", (int) strips.size(), strip_size);
+    write_word((short) strip_size, &strip_buf);
+    write_word((short) strips.size(), &strip_buf);
+
+    for (unsigned int i = 0; i < strips.size(); i++) {
+      write_word((short) strips[i].first, &strip_buf);
+      write_word((short) strips[i].count, &strip_buf);
+    }
+
+    lev_section section = { LEV_SECTION_STRIPS, (unsigned short) (vertical ? LEV_FLAG_VERTICAL : 0), &strip_buf };
+    sections.push_back(section);
+  }
+
+  if (animations) {
+    anim_table table;
+    anim_table_build(&table, tiles, num_tiles);
+    anim_table_cells(&table, planes, layers, w, h, vertical);
+
+    convert_printf(log, "Animations: %d tile(s), %d frame(s), %d cell(s)\n",
+           (int) table.anims.size(), (int) table.frames.size(), (int) table.cells.size());
+    if (verbose) {
+      for (unsigned int i = 0; i < table.anims.size(); i++) {
+        const anim_entry *entry = &table.anims[i];
+        convert_printf(log, "\ttile %d: %d frame(s), %d cell(s)\n", entry->tile, entry->num_frames, entry->num_cells);
+      }
+    }
+    write_anim_table(&table, &anim_buf);
+
+    lev_section section = { LEV_SECTION_ANIMATIONS, (unsigned short) (vertical ? LEV_FLAG_VERTICAL : 0), &anim_buf };
+    sections.push_back(section);
+  }
+
+  if (light_subdiv) {
+    const int ambient = map->GetProperties().GetNumericProperty("ambient");
+
+    lightmap lmap;
+    lightmap_build(&lmap, lights, layers, attrs, map->GetTileWidth(), map->GetTileHeight(), light_subdiv, ambient);
+
+    convert_printf(log, "Lightmap: %dx%d cells from %d light(s), ambient %d\n", lmap.width, lmap.height, (int) lights.size(), ambient);
+    write_lightmap(&lmap, vertical, &light_buf);
+
+    lev_section section = { LEV_SECTION_LIGHTMAP, (unsigned short) (vertical ? LEV_FLAG_VERTICAL : 0), &light_buf };
+    sections.push_back(section);
+  }
+
+  if (nav) {
+    nav_grid grid;
+    nav_grid_build(&grid, layers, attrs, w, h);
+
+    int walkable = 0;
+    for (unsigned int i = 0; i < grid.walkable.size(); i++) {
+      walkable += grid.walkable[i];
+    }
+    convert_printf(log, "Navigation grid: %dx%d, %d walkable cell(s)\n", grid.width, grid.height, walkable);
+
+    unsigned short flags = vertical ? LEV_FLAG_VERTICAL : 0;
+    if (flow_fields) {
+      nav_flow_fields(&grid, targets);
+      convert_printf(log, "Flow fields: %d target(s)\n", (int) targets.size());
+      flags |= LEV_FLAG_FLOW_FIELDS;
+    }
+    write_nav_grid(&grid, targets, flow_fields, vertical, &nav_buf);
+
+    lev_section section = { LEV_SECTION_NAVIGATION, flags, &nav_buf };
+    sections.push_back(section);
+  }
+
+  if (pvs_width) {
+    std::vector<unsigned char> solid;
+    collision_solid(&solid, layers, attrs, w, h);
+
+    // Regions cover at least a screen
+    const int region_width = (pvs_width + map->GetTileWidth() - 1) / map->GetTileWidth();
+    const int region_height = (pvs_height + map->GetTileHeight() - 1) / map->GetTileHeight();
+
+    pvs_table pvs;
+    pvs_build(&pvs, solid, w, h, region_width, region_height, pvs_objects);
+
+    int hidden = 0;
+    for (unsigned int i = 0; i < pvs.masks.size(); i++) {
+      const int col = i % pvs.cols;
+      const int row = i / pvs.cols;
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+          if (col + dx >= 0 && row + dy >= 0 && col + dx < pvs.cols && row + dy < pvs.rows &&
+              !(pvs.masks[i] & (1 << ((dy + 1) * 3 + (dx + 1))))) {
+            hidden++;
+          }
+        }
+      }
+    }
+    convert_printf(log, "Visibility: %dx%d regions of %dx%d tiles, %d neighbour(s) hidden, %d object(s)\n",
+           pvs.cols, pvs.rows, region_width, region_height, hidden, pvs.num_objects);
+    write_pvs(&pvs, vertical, &pvs_buf);
+
+    lev_section section = { LEV_SECTION_VISIBILITY, (unsigned short) (vertical ? LEV_FLAG_VERTICAL : 0), &pvs_buf };
+    sections.push_back(section);
+  }
+
+  if (polygons) {
+    convert_printf(log, "Polygons: %d\n", (int) shapes.size());
+    if (!write_polygons(shapes, &poly_buf, log)) {
+      return 1;
+    }
+
+    lev_section section = { LEV_SECTION_POLYGONS, 0, &poly_buf };
+    sections.push_back(section);
+  }
+
+  write_level(sections, container, out, log);
+  return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef _CONVERT_H
+#define _CONVERT_H
+
+#include <vector>
+#include "Tmx.h"
+#include "lev_file.h"
+
+// Options of a conversion, as given on the command line
+struct convert_options
+{
+  int data_size;
+  bool auto_size;
+  bool verbose;
+  bool vertical;
+  bool legacy;
+  bool bottom;
+  int collision_bits;
+  int area_grid_tiles;
+  int strip_size;
+  bool container;
+  bool compact_paths;
+  bool chunks;
+  const char *cache_name;
+  const char *layer_names;
+  const char *tileset_name;
+  const char *objects_name;
+  const char *areas_name;
+  const char *flatten_pattern;
+  bool crop;
+  bool spans;
+  bool animations;
+  int light_subdiv;
+  bool nav;
+  bool flow_fields;
+  int pvs_width;
+  int pvs_height;
+  bool polygons;
+};
+
+// Receiver of the progress and error messages of a conversion, messages are dropped without a write function
+struct convert_log
+{
+  void (*write)(const char *text, void *user);
+  void *user;
+};
+
+// Set the options to their defaults
+void convert_options_init(convert_options *opts);
+
+// Read the options from a list of arguments, the strings must outlive the options.
+// Returns false on an unknown option, a missing value or a bad option value.
+bool convert_parse_options(convert_options *opts, int count, const char *const *args, convert_log *log);
+
+// Format a message and pass it to the log
+void convert_printf(convert_log *log, const char *format, ...);
+
+// Convert a parsed map into a level, written to out as a stream or a container.
+// Returns 0 on success, else an error code with the reason in the log.
+int convert_level(const Tmx::Map *map, const convert_options *opts, lev_buffer *out, convert_log *log);
+
+#endif
@@ -0,0 +1,308 @@
+#include <math.h>
+#include "convex.h"
+
+// Twice the signed area of triangle (a, b, c), positive when counter clockwise in a y up frame
+static long long cross(const Tmx::Point &a, const Tmx::Point &b, const Tmx::Point &c)
+{
+  return (long long) (b.x - a.x) * (c.y - a.y) - (long long) (b.y - a.y) * (c.x - a.x);
+}
+
+static bool same_point(const Tmx::Point &a, const Tmx::Point &b)
+{
+  return a.x == b.x && a.y == b.y;
+}
+
+// Drop repeated and collinear points and orient the polygon counter clockwise
+static void clean_polygon(std::vector<Tmx::Point> *out, const std::vector<Tmx::Point> &polygon)
+{
+  std::vector<Tmx::Point> points;
+  for (unsigned int i = 0; i < polygon.size(); i++) {
+    if (points.empty() || !same_point(points.back(), polygon[i])) {
+      points.push_back(polygon[i]);
+    }
+  }
+  while (points.size() > 1 && same_point(points.front(), points.back())) {
+    points.pop_back();
+  }
+
+  bool removed = true;
+  while (removed && points.size() >= 3) {
+    removed = false;
+    for (unsigned int i = 0; i < points.size() && points.size() >= 3; i++) {
+      const int n = points.size();
+      if (cross(points[(i + n - 1) % n], points[i], points[(i + 1) % n]) == 0) {
+        points.erase(points.begin() + i);
+        removed = true;
+      }
+    }
+  }
+
+  long long area = 0;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    const Tmx::Point &a = points[i];
+    const Tmx::Point &b = points[(i + 1) % points.size()];
+    area += (long long) a.x * b.y - (long long) b.x * a.y;
+  }
+  if (area < 0) {
+    out->assign(points.rbegin(), points.rend());
+  }
+  else {
+    out->swap(points);
+  }
+}
+
+// Check whether p lies inside triangle (a, b, c) or on its edges
+static bool in_triangle(const Tmx::Point &p, const Tmx::Point &a, const Tmx::Point &b, const Tmx::Point &c)
+{
+  return cross(a, b, p) >= 0 && cross(b, c, p) >= 0 && cross(c, a, p) >= 0;
+}
+
+// Check whether segments (a, b) and (c, d) cross at a point inside both
+static bool segments_cross(const Tmx::Point &a, const Tmx::Point &b, const Tmx::Point &c, const Tmx::Point &d)
+{
+  const long long d1 = cross(a, b, c);
+  const long long d2 = cross(a, b, d);
+  const long long d3 = cross(c, d, a);
+  const long long d4 = cross(c, d, b);
+
+  return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+static bool is_simple(const std::vector<Tmx::Point> &points)
+{
+  const int n = points.size();
+  for (int i = 0; i < n; i++) {
+    for (int j = i + 2; j < n; j++) {
+      if (i == 0 && j == n - 1) {
+        continue;
+      }
+      if (segments_cross(points[i], points[(i + 1) % n], points[j], points[(j + 1) % n])) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Split the polygon into triangles, as triples of point indices
+static bool triangulate(std::vector<std::vector<int> > *triangles, const std::vector<Tmx::Point> &points)
+{
+  std::vector<int> remaining;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    remaining.push_back(i);
+  }
+
+  while (remaining.size() > 3) {
+    const int n = remaining.size();
+    bool clipped = false;
+
+    for (int i = 0; i < n && !clipped; i++) {
+      const int prev = remaining[(i + n - 1) % n];
+      const int cur = remaining[i];
+      const int next = remaining[(i + 1) % n];
+      if (cross(points[prev], points[cur], points[next]) <= 0) {
+        continue;
+      }
+
+      // An ear holds none of the other remaining points
+      bool ear = true;
+      for (int j = 0; j < n && ear; j++) {
+        const int k = remaining[j];
+        if (k == prev || k == cur || k == next) {
+          continue;
+        }
+        if (in_triangle(points[k], points[prev], points[cur], points[next]) &&
+            !same_point(points[k], points[prev]) && !same_point(points[k], points[next])) {
+          ear = false;
+        }
+      }
+
+      if (ear) {
+        std::vector<int> triangle;
+        triangle.push_back(prev);
+        triangle.push_back(cur);
+        triangle.push_back(next);
+        triangles->push_back(triangle);
+        remaining.erase(remaining.begin() + i);
+        clipped = true;
+      }
+    }
+
+    if (!clipped) {
+      return false;
+    }
+  }
+
+  triangles->push_back(remaining);
+  return true;
+}
+
+static bool is_convex(const std::vector<int> &piece, const std::vector<Tmx::Point> &points)
+{
+  const int n = piece.size();
+  for (int i = 0; i < n; i++) {
+    if (cross(points[piece[i]], points[piece[(i + 1) % n]], points[piece[(i + 2) % n]]) < 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Join pieces a and b along their shared edge, returns false if they share none
+static bool join_pieces(std::vector<int> *joined, const std::vector<int> &a, const std::vector<int> &b)
+{
+  const int na = a.size();
+  const int nb = b.size();
+
+  for (int i = 0; i < na; i++) {
+    for (int j = 0; j < nb; j++) {
+      // Edge i of a runs opposite to edge j of b
+      if (a[i] != b[(j + 1) % nb] || a[(i + 1) % na] != b[j]) {
+        continue;
+      }
+
+      joined->clear();
+      for (int k = 0; k < na; k++) {
+        joined->push_back(a[(i + 1 + k) % na]);
+      }
+      for (int k = 2; k < nb; k++) {
+        joined->push_back(b[(j + k) % nb]);
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool convex_decompose(std::vector<convex_piece> *pieces, const std::vector<Tmx::Point> &polygon)
+{
+  std::vector<Tmx::Point> points;
+  clean_polygon(&points, polygon);
+
+  std::vector<std::vector<int> > parts;
+  if (points.size() < 3 || !is_simple(points) || !triangulate(&parts, points)) {
+    return false;
+  }
+
+  // Remove diagonals as long as the piece on both sides stays convex
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (unsigned int i = 0; i < parts.size() && !merged; i++) {
+      for (unsigned int j = i + 1; j < parts.size() && !merged; j++) {
+        std::vector<int> joined;
+        if (join_pieces(&joined, parts[i], parts[j]) && is_convex(joined, points)) {
+          parts[i].swap(joined);
+          parts.erase(parts.begin() + j);
+          merged = true;
+        }
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < parts.size(); i++) {
+    convex_piece piece;
+    for (unsigned int j = 0; j < parts[i].size(); j++) {
+      piece.points.push_back(points[parts[i][j]]);
+    }
+
+    const int n = piece.points.size();
+    for (int j = 0; j < n; j++) {
+      const Tmx::Point &a = piece.points[j];
+      const Tmx::Point &b = piece.points[(j + 1) % n];
+      const double length = sqrt((double) (b.x - a.x) * (b.x - a.x) + (double) (b.y - a.y) * (b.y - a.y));
+
+      // Counter clockwise pieces have the inside to the left of every edge
+      Tmx::Point normal;
+      normal.x = (int) floor((b.y - a.y) / length * CONVEX_NORMAL_ONE + 0.5);
+      normal.y = (int) floor((a.x - b.x) / length * CONVEX_NORMAL_ONE + 0.5);
+      piece.normals.push_back(normal);
+    }
+
+    convex_bounds(&piece.box, piece.points);
+    pieces->push_back(piece);
+  }
+
+  return true;
+}
+
+void convex_bounds(convex_box *box, const std::vector<Tmx::Point> &points)
+{
+  box->x0 = box->y0 = box->x1 = box->y1 = 0;
+
+  for (unsigned int i = 0; i < points.size(); i++) {
+    if (i == 0 || points[i].x < box->x0) {
+      box->x0 = points[i].x;
+    }
+    if (i == 0 || points[i].y < box->y0) {
+      box->y0 = points[i].y;
+    }
+    if (i == 0 || points[i].x > box->x1) {
+      box->x1 = points[i].x;
+    }
+    if (i == 0 || points[i].y > box->y1) {
+      box->y1 = points[i].y;
+    }
+  }
+}
+
+// Even-odd test of point (px, py) against a polygon
+static bool polygon_contains(const std::vector<Tmx::Point> &points, double px, double py)
+{
+  bool inside = false;
+  const int n = points.size();
+
+  for (int i = 0, j = n - 1; i < n; j = i++) {
+    const Tmx::Point &a = points[i];
+    const Tmx::Point &b = points[j];
+    if ((a.y > py) != (b.y > py) && px < (double) (b.x - a.x) * (py - a.y) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+
+  return inside;
+}
+
+// Separating axis style test of a point against the edge normals of a piece
+static bool piece_contains(const convex_piece &piece, double px, double py)
+{
+  for (unsigned int i = 0; i < piece.points.size(); i++) {
+    const Tmx::Point &a = piece.points[i];
+    if ((px - a.x) * piece.normals[i].x + (py - a.y) * piece.normals[i].y > 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int convex_check(const std::vector<convex_piece> &pieces, const std::vector<Tmx::Point> &polygon, int samples)
+{
+  convex_box box;
+  convex_bounds(&box, polygon);
+
+  int mismatches = 0;
+  for (int sy = 0; sy < samples; sy++) {
+    for (int sx = 0; sx < samples; sx++) {
+      // Offsets keep the samples off the vertices and edges of integer polygons
+      const double px = box.x0 + (box.x1 - box.x0) * (sx + 0.4142) / samples;
+      const double py = box.y0 + (box.y1 - box.y0) * (sy + 0.7321) / samples;
+
+      int count = 0;
+      for (unsigned int i = 0; i < pieces.size(); i++) {
+        if (piece_contains(pieces[i], px, py)) {
+          count++;
+        }
+      }
+
+      if (count != (polygon_contains(polygon, px, py) ? 1 : 0)) {
+        mismatches++;
+      }
+    }
+  }
+
+  return mismatches;
+}
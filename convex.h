@@ -0,0 +1,41 @@
+#ifndef _CONVEX_H
+#define _CONVEX_H
+
+#include <vector>
+#include "Tmx.h"
+
+// Fixed point scale of edge normals, 2.14
+#define CONVEX_NORMAL_ONE 16384
+
+// Axis aligned bounding box, in pixels, max inclusive
+struct convex_box
+{
+  int x0;
+  int y0;
+  int x1;
+  int y1;
+};
+
+// Convex piece of a polygon with its bounding box and the outward unit normal of each
+// edge, edge i going from point i to point i + 1
+struct convex_piece
+{
+  std::vector<Tmx::Point> points;
+  std::vector<Tmx::Point> normals;
+  convex_box box;
+};
+
+// Split a simple polygon into few convex pieces: ear clipping into triangles, then
+// Hertel-Mehlhorn removal of the diagonals that keep both sides convex.
+// Returns false if the polygon is degenerate or intersects itself.
+bool convex_decompose(std::vector<convex_piece> *pieces, const std::vector<Tmx::Point> &polygon);
+
+// Get the bounding box of a list of points
+void convex_bounds(convex_box *box, const std::vector<Tmx::Point> &points);
+
+// Compare the pieces with the polygon at up to samples x samples points of its bounding box,
+// every point inside the polygon must be in exactly one piece and every other point in none.
+// Returns the number of points that disagree.
+int convex_check(const std::vector<convex_piece> &pieces, const std::vector<Tmx::Point> &polygon, int samples);
+
+#endif
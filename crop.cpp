@@ -0,0 +1,100 @@
+#include "crop.h"
+
+void crop_bounds(crop_box *box, const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int height)
+{
+  int x0 = width;
+  int y0 = height;
+  int x1 = -1;
+  int y1 = -1;
+
+  for (int y = 0; y < height; y++) {
+    int x = 0;
+    while (x < width && plane_tile_empty(p, layers, width, x, y)) {
+      x++;
+    }
+
+    if (x == width) {
+      continue;
+    }
+
+    // Cells left of the right edge found so far can not widen the box
+    int last = width - 1;
+    while (last > x && last > x1 && plane_tile_empty(p, layers, width, last, y)) {
+      last--;
+    }
+
+    x0 = x < x0 ? x : x0;
+    x1 = last > x1 ? last : x1;
+    y0 = y < y0 ? y : y0;
+    y1 = y;
+  }
+
+  if (x1 < 0) {
+    box->x = box->y = box->width = box->height = 0;
+    return;
+  }
+
+  box->x = x0;
+  box->y = y0;
+  box->width = x1 - x0 + 1;
+  box->height = y1 - y0 + 1;
+}
+
+void crop_spans(std::vector<crop_span> *spans, const crop_box *box, const plane *p,
+                const std::vector<const Tmx::Layer *> &layers, int width, bool vertical)
+{
+  const int outer = vertical ? box->width : box->height;
+  const int inner = vertical ? box->height : box->width;
+
+  spans->resize(outer);
+
+  for (int o = 0; o < outer; o++) {
+    int first = 0;
+    int last = inner - 1;
+
+    while (first < inner) {
+      const int x = box->x + (vertical ? o : first);
+      const int y = box->y + (vertical ? first : o);
+      if (!plane_tile_empty(p, layers, width, x, y)) {
+        break;
+      }
+      first++;
+    }
+
+    while (last > first) {
+      const int x = box->x + (vertical ? o : last);
+      const int y = box->y + (vertical ? last : o);
+      if (!plane_tile_empty(p, layers, width, x, y)) {
+        break;
+      }
+      last--;
+    }
+
+    (*spans)[o].first = first < inner ? first : 0;
+    (*spans)[o].count = first < inner ? last - first + 1 : 0;
+  }
+}
+
+int crop_plane_bytes(const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int height,
+                     int tile_size, bool crop, bool spans, bool vertical)
+{
+  crop_box box = { 0, 0, width, height };
+  if (!crop) {
+    return width * height * tile_size;
+  }
+
+  crop_bounds(&box, p, layers, width, height);
+  if (!spans) {
+    return 8 + box.width * box.height * tile_size;
+  }
+
+  std::vector<crop_span> line_spans;
+  crop_spans(&line_spans, &box, p, layers, width, vertical);
+
+  int bytes = 8 + line_spans.size() * 4;
+  for (unsigned int i = 0; i < line_spans.size(); i++) {
+    bytes += line_spans[i].count * tile_size;
+  }
+
+  return bytes;
+}
@@ -0,0 +1,35 @@
+#ifndef _CROP_H
+#define _CROP_H
+
+#include <vector>
+#include "flatten.h"
+
+// Smallest rectangle holding every non-empty cell of a plane, in tiles, all zero for an empty plane
+struct crop_box
+{
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// Run of cells from the first to the last non-empty cell of one row or column of a crop box
+struct crop_span
+{
+  int first;
+  int count;
+};
+
+// Find the bounding box of the non-empty cells of a width x height plane
+void crop_bounds(crop_box *box, const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int height);
+
+// Find the span of every row of the box, or every column when vertical, relative to the box
+void crop_spans(std::vector<crop_span> *spans, const crop_box *box, const plane *p,
+                const std::vector<const Tmx::Layer *> &layers, int width, bool vertical);
+
+// Get the number of bytes the tiles of a plane take in the layer section, with the box
+// and the span table when cropped
+int crop_plane_bytes(const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int height,
+                     int tile_size, bool crop, bool spans, bool vertical);
+
+#endif
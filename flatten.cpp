@@ -0,0 +1,108 @@
+#include "tile_types.h"
+#include "flatten.h"
+
+// Composite the upper tile onto the lower one, -1 meaning empty.
+// An opaque tile hides what is below it, an overlay tile is drawn over its bg_tile,
+// so the result only matches the separate layers if the lower tile is that bg_tile.
+// The game also combines the collision masks and looks up the types of the tiles of
+// every layer, so an opaque tile may only hide a tile of the same type and mask.
+static bool merge_cell(int lower, int upper, const std::vector<tile_attr> &attrs, int *result)
+{
+  if (upper < 0 || lower < 0) {
+    *result = upper < 0 ? lower : upper;
+    return true;
+  }
+
+  const unsigned char type = upper < (int) attrs.size() ? (unsigned char) attrs[upper].type : TILE_TYPE_NONE;
+  if (type & TILE_TYPE_OVERLAY) {
+    *result = upper;
+    return lower == (type >> 1);
+  }
+
+  // Tiles without a type may have transparent parts
+  *result = upper;
+  if (type == TILE_TYPE_NONE || lower >= (int) attrs.size()) {
+    return false;
+  }
+
+  return attrs[lower].type == attrs[upper].type && attrs[lower].mask == attrs[upper].mask;
+}
+
+static void plane_load(plane *p, const Tmx::Layer *layer, int width, int height)
+{
+  p->tiles.resize(width * height);
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      p->tiles[y * width + x] = layer->GetTileTilesetIndex(x, y) < 0 ? -1 : (int) layer->GetTileId(x, y);
+    }
+  }
+}
+
+static bool plane_merge(plane *p, const Tmx::Layer *layer, const std::vector<tile_attr> &attrs, int width, int height)
+{
+  std::vector<int> tiles(p->tiles.size());
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const int upper = layer->GetTileTilesetIndex(x, y) < 0 ? -1 : (int) layer->GetTileId(x, y);
+      if (!merge_cell(p->tiles[y * width + x], upper, attrs, &tiles[y * width + x])) {
+        return false;
+      }
+    }
+  }
+
+  p->tiles.swap(tiles);
+  return true;
+}
+
+void flatten_layers(std::vector<plane> *planes, const std::vector<const Tmx::Layer *> &layers,
+                    const std::vector<bool> &candidates, const std::vector<tile_attr> &attrs, int width, int height)
+{
+  planes->clear();
+
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    plane *last = planes->empty() ? NULL : &planes->back();
+    const bool open = last && candidates[i] && candidates[last->layers.back()] && last->layers.back() == (int) i - 1;
+
+    if (open) {
+      if (last->tiles.empty()) {
+        plane_load(last, layers[last->layers[0]], width, height);
+      }
+
+      if (plane_merge(last, layers[i], attrs, width, height)) {
+        last->layers.push_back(i);
+        continue;
+      }
+    }
+
+    planes->push_back(plane());
+    planes->back().layers.push_back(i);
+  }
+
+  // Planes of a single layer read their tiles from the layer
+  for (unsigned int i = 0; i < planes->size(); i++) {
+    if ((*planes)[i].layers.size() == 1) {
+      std::vector<int>().swap((*planes)[i].tiles);
+    }
+  }
+}
+
+unsigned plane_tile_id(const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int x, int y)
+{
+  if (p->tiles.empty()) {
+    return layers[p->layers[0]]->GetTileId(x, y);
+  }
+
+  const int id = p->tiles[y * width + x];
+  return id < 0 ? 0 : id;
+}
+
+bool plane_tile_empty(const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int x, int y)
+{
+  if (p->tiles.empty()) {
+    return layers[p->layers[0]]->GetTileTilesetIndex(x, y) < 0;
+  }
+
+  return p->tiles[y * width + x] < 0;
+}
@@ -0,0 +1,26 @@
+#ifndef _FLATTEN_H
+#define _FLATTEN_H
+
+#include <vector>
+#include "Tmx.h"
+#include "collision.h"
+
+// One output plane, made of one layer or of several layers composited bottom to top
+struct plane
+{
+  std::vector<int> layers;
+  std::vector<int> tiles;
+};
+
+// Group layers into planes, merging runs of adjacent candidate layers as long as no visible tile,
+// collision mask or tile type is lost
+void flatten_layers(std::vector<plane> *planes, const std::vector<const Tmx::Layer *> &layers,
+                    const std::vector<bool> &candidates, const std::vector<tile_attr> &attrs, int width, int height);
+
+// Get the tile id of a plane cell as written to the level, 0 when empty
+unsigned plane_tile_id(const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int x, int y);
+
+// Get whether a plane cell has no tile in any of its layers
+bool plane_tile_empty(const plane *p, const std::vector<const Tmx::Layer *> &layers, int width, int x, int y);
+
+#endif
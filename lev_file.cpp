@@ -0,0 +1,141 @@
+#include <zlib.h>
+#include "lev_file.h"
+
+void write_byte(int value, lev_buffer *buf)
+{
+  buf->data.push_back((unsigned char) value);
+}
+
+void write_word(short value, lev_buffer *buf)
+{
+#define SWAP
+#ifdef SWAP
+  buf->data.push_back((value & 0xff00) >> 8);
+  buf->data.push_back(value & 0x00ff);
+#else
+  const unsigned char *bytes = (const unsigned char *) &value;
+  buf->data.insert(buf->data.end(), bytes, bytes + sizeof(value));
+#endif
+}
+
+void write_long(int value, lev_buffer *buf)
+{
+  write_word((short) ((value >> 16) & 0xffff), buf);
+  write_word((short) (value & 0xffff), buf);
+}
+
+static unsigned align_offset(unsigned offset)
+{
+  return (offset + LEV_ALIGN - 1) & ~(LEV_ALIGN - 1);
+}
+
+static unsigned read_word(const unsigned char *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+static unsigned read_long(const unsigned char *p)
+{
+  return ((unsigned) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void lev_build_stream(const std::vector<lev_section> &sections, lev_buffer *out)
+{
+  for (unsigned int i = 0; i < sections.size(); i++) {
+    const std::vector<unsigned char> &data = sections[i].buf->data;
+    out->data.insert(out->data.end(), data.begin(), data.end());
+  }
+}
+
+void lev_build_container(const std::vector<lev_section> &sections, lev_buffer *out)
+{
+  const unsigned start = out->data.size();
+
+  // Lay out the sections after the directory
+  std::vector<unsigned> offsets(sections.size());
+  unsigned offset = align_offset(LEV_HEADER_SIZE + LEV_ENTRY_SIZE * sections.size());
+  for (unsigned int i = 0; i < sections.size(); i++) {
+    offsets[i] = offset;
+    offset = align_offset(offset + sections[i].buf->data.size());
+  }
+
+  write_long(LEV_MAGIC, out);
+  write_word(LEV_VERSION, out);
+  write_word((short) sections.size(), out);
+  write_long(offset, out);
+
+  for (unsigned int i = 0; i < sections.size(); i++) {
+    const std::vector<unsigned char> &data = sections[i].buf->data;
+    unsigned checksum = crc32(0L, Z_NULL, 0);
+    if (!data.empty()) {
+      checksum = crc32(checksum, &data[0], data.size());
+    }
+
+    write_long(sections[i].id, out);
+    write_long(offsets[i], out);
+    write_long(data.size(), out);
+    write_word(sections[i].flags, out);
+    write_word(0, out);
+    write_long(checksum, out);
+  }
+
+  for (unsigned int i = 0; i < sections.size(); i++) {
+    const std::vector<unsigned char> &data = sections[i].buf->data;
+    out->data.resize(start + offsets[i], 0);
+    out->data.insert(out->data.end(), data.begin(), data.end());
+  }
+  out->data.resize(start + offset, 0);
+}
+
+int lev_num_sections(const unsigned char *base, unsigned size)
+{
+  if (size < LEV_HEADER_SIZE || read_long(base) != LEV_MAGIC || read_word(base + 4) != LEV_VERSION) {
+    return -1;
+  }
+
+  const unsigned num_sections = read_word(base + 6);
+  if (LEV_HEADER_SIZE + LEV_ENTRY_SIZE * num_sections > size) {
+    return -1;
+  }
+
+  return num_sections;
+}
+
+bool lev_get_entry(const unsigned char *base, unsigned size, int index, lev_entry *entry)
+{
+  if (index < 0 || index >= lev_num_sections(base, size)) {
+    return false;
+  }
+
+  const unsigned char *p = base + LEV_HEADER_SIZE + LEV_ENTRY_SIZE * index;
+  entry->id = read_long(p);
+  entry->offset = read_long(p + 4);
+  entry->size = read_long(p + 8);
+  entry->flags = read_word(p + 12);
+  entry->checksum = read_long(p + 16);
+
+  return entry->offset <= size && entry->size <= size - entry->offset;
+}
+
+const unsigned char *lev_find_section(const unsigned char *base, unsigned size, unsigned id, lev_entry *entry)
+{
+  const int num_sections = lev_num_sections(base, size);
+
+  for (int i = 0; i < num_sections; i++) {
+    if (lev_get_entry(base, size, i, entry) && entry->id == id) {
+      return base + entry->offset;
+    }
+  }
+
+  return NULL;
+}
+
+bool lev_verify_section(const unsigned char *base, const lev_entry *entry)
+{
+  unsigned checksum = crc32(0L, Z_NULL, 0);
+  if (entry->size) {
+    checksum = crc32(checksum, base + entry->offset, entry->size);
+  }
+
+  return checksum == entry->checksum;
+}
@@ -0,0 +1,101 @@
+#ifndef _LEV_FILE_H
+#define _LEV_FILE_H
+
+#include <vector>
+
+// Container format, all values big endian:
+//   header     magic "JLEV", version (word), number of sections (word), file size (long)
+//   directory  per section: id (long), offset (long), size (long), flags (word), reserved (word), crc32 (long)
+//   sections   each starting on a LEV_ALIGN byte boundary from the start of the file
+#define LEV_MAGIC           0x4A4C4556
+#define LEV_VERSION         1
+#define LEV_ALIGN           8
+#define LEV_HEADER_SIZE     12
+#define LEV_ENTRY_SIZE      20
+
+#define LEV_ID(a, b, c, d)  (((unsigned) (a) << 24) | ((unsigned) (b) << 16) | ((unsigned) (c) << 8) | (unsigned) (d))
+
+#define LEV_SECTION_TILES     LEV_ID('T', 'I', 'L', 'E')
+#define LEV_SECTION_LAYERS    LEV_ID('L', 'A', 'Y', 'R')
+#define LEV_SECTION_OBJECTS   LEV_ID('O', 'B', 'J', 'S')
+#define LEV_SECTION_AREAS     LEV_ID('A', 'R', 'E', 'A')
+#define LEV_SECTION_COLLISION LEV_ID('C', 'O', 'L', 'L')
+#define LEV_SECTION_AREA_GRID LEV_ID('A', 'G', 'R', 'D')
+#define LEV_SECTION_STRIPS    LEV_ID('S', 'T', 'R', 'P')
+#define LEV_SECTION_ANIMATIONS LEV_ID('A', 'N', 'I', 'M')
+#define LEV_SECTION_LIGHTMAP  LEV_ID('L', 'G', 'H', 'T')
+#define LEV_SECTION_NAVIGATION LEV_ID('N', 'A', 'V', 'G')
+#define LEV_SECTION_VISIBILITY LEV_ID('P', 'V', 'I', 'S')
+#define LEV_SECTION_POLYGONS  LEV_ID('P', 'O', 'L', 'Y')
+
+// Sections of the world index, see world.h
+#define LEV_SECTION_WORLD_LEVELS LEV_ID('W', 'L', 'V', 'L')
+#define LEV_SECTION_WORLD_DOORS  LEV_ID('W', 'D', 'O', 'R')
+
+// Section data is stored column by column
+#define LEV_FLAG_VERTICAL   0x0001
+// Tile ids are stored as bytes instead of words
+#define LEV_FLAG_BYTE_TILES 0x0002
+// Collision cells are packed to one bit each
+#define LEV_FLAG_PACKED     0x0004
+// Npc paths use the compact delta encoding from path_codec.h
+#define LEV_FLAG_COMPACT_PATHS 0x0008
+// Layers of infinite maps are stored as a chunk count followed by
+// position, size and tiles of each chunk
+#define LEV_FLAG_CHUNKED    0x0010
+// Every layer starts with a byte giving its number of bytes per tile
+#define LEV_FLAG_LAYER_SIZES 0x0020
+// Every layer starts with the position and size of the box holding its tiles
+#define LEV_FLAG_CROPPED    0x0040
+// Every row of a cropped layer, or column when vertical, is stored as a span:
+// a first/count word pair per row comes before the tiles of all spans
+#define LEV_FLAG_SPANS      0x0080
+// The walkability grid is followed by flow fields, four bits per cell
+#define LEV_FLAG_FLOW_FIELDS 0x0100
+
+struct lev_buffer
+{
+  std::vector<unsigned char> data;
+};
+
+void write_byte(int value, lev_buffer *buf);
+void write_word(short value, lev_buffer *buf);
+void write_long(int value, lev_buffer *buf);
+
+// Section to be written, in output order
+struct lev_section
+{
+  unsigned id;
+  unsigned short flags;
+  const lev_buffer *buf;
+};
+
+// Append the sections back to back as the plain sequential stream
+void lev_build_stream(const std::vector<lev_section> &sections, lev_buffer *out);
+
+// Append the sections as a container with header and section directory
+void lev_build_container(const std::vector<lev_section> &sections, lev_buffer *out);
+
+// Directory entry of a section in a container
+struct lev_entry
+{
+  unsigned id;
+  unsigned offset;
+  unsigned size;
+  unsigned short flags;
+  unsigned checksum;
+};
+
+// Get the number of sections of a container in memory, -1 if it is not a valid container
+int lev_num_sections(const unsigned char *base, unsigned size);
+
+// Read the directory entry at index, fails if the section lies outside the container
+bool lev_get_entry(const unsigned char *base, unsigned size, int index, lev_entry *entry);
+
+// Find the section with the given id, returns NULL if not present
+const unsigned char *lev_find_section(const unsigned char *base, unsigned size, unsigned id, lev_entry *entry);
+
+// Check the section data against the checksum in its directory entry
+bool lev_verify_section(const unsigned char *base, const lev_entry *entry);
+
+#endif
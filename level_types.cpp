@@ -0,0 +1,17 @@
+#include "level_types.h"
+#include "type_schema.h"
+
+enum object_type get_object_type(const char *str)
+{
+  return (enum object_type) type_lookup(TYPE_KIND_OBJECT, str, OBJECT_TYPE_UNKNOWN);
+}
+
+enum direction get_direction(const char *str)
+{
+  return (enum direction) type_lookup(TYPE_KIND_DIRECTION, str, MAX_DIRECTION);
+}
+
+enum area_type get_area_type(const char *str)
+{
+  return (enum area_type) type_lookup(TYPE_KIND_AREA, str, AREA_TYPE_UNKNOWN);
+}
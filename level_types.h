@@ -0,0 +1,36 @@
+#ifndef _LEVEL_TYPES_H
+#define _LEVEL_TYPES_H
+
+// Enums generated from the object, area and direction rows of level_types.def
+
+enum direction
+{
+#define DIRECTION(constant, name, code) constant = code,
+#include "level_types.def"
+  MAX_DIRECTION
+};
+
+enum object_type
+{
+  OBJECT_TYPE_UNKNOWN = 0,
+#define OBJECT_TYPE(constant, name, code) constant = code,
+#include "level_types.def"
+};
+
+enum area_type
+{
+  AREA_TYPE_UNKNOWN = 0,
+#define AREA_TYPE(constant, name, code) constant = code,
+#include "level_types.def"
+};
+
+// Get the object type of a type name, OBJECT_TYPE_UNKNOWN if unknown
+enum object_type get_object_type(const char *str);
+
+// Get the direction of a direction property value, MAX_DIRECTION if unknown
+enum direction get_direction(const char *str);
+
+// Get the area type of a type name, AREA_TYPE_UNKNOWN if unknown
+enum area_type get_area_type(const char *str);
+
+#endif
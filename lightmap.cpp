@@ -0,0 +1,115 @@
+#include <math.h>
+#include <stdlib.h>
+#include "lightmap.h"
+
+// Rows of cells worth a thread of their own
+#define LIGHTMAP_MIN_ROWS 16
+
+// Walk the tiles crossed by the ray from (x0, y0) to (x1, y1), in tiles, and check
+// that none between the first and the last one blocks the light
+static bool light_reaches(const std::vector<unsigned char> &opaque, int width, int height,
+                          double x0, double y0, double x1, double y1)
+{
+  int tx = (int) floor(x0);
+  int ty = (int) floor(y0);
+  const int steps = abs((int) floor(x1) - tx) + abs((int) floor(y1) - ty);
+
+  const double dx = x1 - x0;
+  const double dy = y1 - y0;
+  const int step_x = dx > 0 ? 1 : -1;
+  const int step_y = dy > 0 ? 1 : -1;
+  const double delta_x = dx != 0 ? fabs(1.0 / dx) : HUGE_VAL;
+  const double delta_y = dy != 0 ? fabs(1.0 / dy) : HUGE_VAL;
+  double next_x = dx != 0 ? (dx > 0 ? tx + 1 - x0 : x0 - tx) * delta_x : HUGE_VAL;
+  double next_y = dy != 0 ? (dy > 0 ? ty + 1 - y0 : y0 - ty) * delta_y : HUGE_VAL;
+
+  for (int i = 1; i < steps; i++) {
+    if (next_x < next_y) {
+      next_x += delta_x;
+      tx += step_x;
+    }
+    else {
+      next_y += delta_y;
+      ty += step_y;
+    }
+
+    if (tx >= 0 && ty >= 0 && tx < width && ty < height && opaque[ty * width + tx]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void lightmap_build(lightmap *lmap, const std::vector<light_source> &lights, const std::vector<const Tmx::Layer *> &layers,
+                    const std::vector<tile_attr> &attrs, int tile_width, int tile_height, int subdiv, int ambient)
+{
+  const int map_width = layers[0]->GetWidth();
+  const int map_height = layers[0]->GetHeight();
+
+  lmap->width = map_width * subdiv;
+  lmap->height = map_height * subdiv;
+  lmap->subdiv = subdiv;
+  lmap->cells.assign(lmap->width * lmap->height, (unsigned char) (ambient < 0 ? 0 : ambient > 255 ? 255 : ambient));
+
+  std::vector<unsigned char> opaque;
+  collision_solid(&opaque, layers, attrs, map_width, map_height);
+
+  // Every task owns a band of rows, so no two tasks write the same cell
+  const int num_tasks = Tmx::Util::GetNumTasks(lmap->height, LIGHTMAP_MIN_ROWS);
+  Tmx::Util::ParallelFor(num_tasks, [&](int task) {
+    const int row_begin = (int) ((long long) lmap->height * task / num_tasks);
+    const int row_end = (int) ((long long) lmap->height * (task + 1) / num_tasks);
+
+    for (unsigned int i = 0; i < lights.size(); i++) {
+      const light_source &light = lights[i];
+      if (light.radius <= 0) {
+        continue;
+      }
+
+      // Light position and reach in cells
+      const double lx = (double) light.x * subdiv / tile_width;
+      const double ly = (double) light.y * subdiv / tile_height;
+      const double radius = light.radius * subdiv;
+
+      int y0 = (int) floor(ly - radius);
+      int y1 = (int) ceil(ly + radius);
+      int x0 = (int) floor(lx - radius);
+      int x1 = (int) ceil(lx + radius);
+      y0 = y0 < row_begin ? row_begin : y0;
+      y1 = y1 > row_end ? row_end : y1;
+      x0 = x0 < 0 ? 0 : x0;
+      x1 = x1 > lmap->width ? lmap->width : x1;
+
+      for (int y = y0; y < y1; y++) {
+        unsigned char *row = &lmap->cells[y * lmap->width];
+
+        for (int x = x0; x < x1; x++) {
+          const double cx = x + 0.5;
+          const double cy = y + 0.5;
+          const double dist = sqrt((cx - lx) * (cx - lx) + (cy - ly) * (cy - ly));
+          if (dist >= radius) {
+            continue;
+          }
+
+          if (!light_reaches(opaque, map_width, map_height, lx / subdiv, ly / subdiv, cx / subdiv, cy / subdiv)) {
+            continue;
+          }
+
+          // Lights add up, saturating at full brightness
+          const int level = row[x] + (int) (255 * (1.0 - dist / radius));
+          row[x] = (unsigned char) (level > 255 ? 255 : level);
+        }
+      }
+    }
+  });
+}
+
+unsigned char lightmap_get(const lightmap *lmap, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= lmap->width || y >= lmap->height) {
+    return 0;
+  }
+
+  return lmap->cells[y * lmap->width + x];
+}
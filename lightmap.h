@@ -0,0 +1,33 @@
+#ifndef _LIGHTMAP_H
+#define _LIGHTMAP_H
+
+#include <vector>
+#include "collision.h"
+
+// Light object, position in pixels and reach in tiles
+struct light_source
+{
+  int x;
+  int y;
+  int radius;
+};
+
+// Light level of every cell of the map, subdiv x subdiv cells per tile
+struct lightmap
+{
+  int width;
+  int height;
+  int subdiv;
+  std::vector<unsigned char> cells;
+};
+
+// Bake the light falling on every cell, starting from the ambient level. Each light
+// fades out linearly over its radius and is stopped by rock and metal tiles in any layer.
+// Rows of cells are lit in parallel.
+void lightmap_build(lightmap *lmap, const std::vector<light_source> &lights, const std::vector<const Tmx::Layer *> &layers,
+                    const std::vector<tile_attr> &attrs, int tile_width, int tile_height, int subdiv, int ambient);
+
+// Get the light level of cell (x, y), zero outside the map
+unsigned char lightmap_get(const lightmap *lmap, int x, int y);
+
+#endif
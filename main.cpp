@@ -1,474 +1,225 @@
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
-#include "tile_types.h"
+#include <sys/stat.h>
 #include "Tmx.h"
+#include "lev_file.h"
+#include "world.h"
+#include "convert.h"
 
-enum direction
+// Write a whole level file
+static bool write_file(const char *file_name, const lev_buffer *buf)
 {
-  N, W, S, E, NW, SW, NE, SE, MAX_DIRECTION
-};
-
-enum object_type
-{
-  OBJECT_TYPE_UNKNOWN = 0,
-  OBJECT_TYPE_ENEMY,
-  OBJECT_TYPE_BOSS,
-  OBJECT_TYPE_ITEM,
-  OBJECT_TYPE_SAVETUBE,
-  OBJECT_TYPE_LIGHT,
-  OBJECT_TYPE_NPC,
-  OBJECT_TYPE_STATIC
-};
-
-enum area_type
-{
-  AREA_TYPE_UNKNOWN,
-  AREA_TYPE_DOOR,
-  AREA_TYPE_DAMAGE,
-  AREA_TYPE_TRIGGER
-};
-
-void write_word(short value, FILE *fp) {
-#define SWAP
-#ifdef SWAP
-  fputc((value & 0xff00) >> 8, fp);
-  fputc(value & 0x00ff, fp);
-#else
-  short to_write = value;
-  fwrite(&to_write, sizeof(to_write), 1, fp);
-#endif
-}
-
-char get_tile_type(const char *str)
-{
-  char result = TILE_TYPE_NONE;
-
-  if (strcmp(str, "floor") == 0)
-    result = TILE_TYPE_FLOOR;
-  else if (strcmp(str, "rock") == 0)
-    result = TILE_TYPE_ROCK;
-  else if (strcmp(str, "metal") == 0)
-    result = TILE_TYPE_METAL;
-  else if (strcmp(str, "special_1") == 0)
-    result = TILE_TYPE_SPECIAL_1;
-  else if (strcmp(str, "special_2") == 0)
-    result = TILE_TYPE_SPECIAL_2;
-  else if (strcmp(str, "overlay") == 0)
-    result = TILE_TYPE_OVERLAY;
-
-  return result;
-}
-
-int get_max_tiles(const Tmx::Tileset *tileset)
-{
-  int w  = (tileset->GetImage())->GetWidth();
-  int h  = (tileset->GetImage())->GetHeight();
+  FILE *fp = fopen(file_name, "wb");
+  if (fp == NULL) {
+    printf("error: unable to create file %s\n", file_name);
+    return false;
+  }
 
-  int tw = tileset->GetTileWidth();
-  int th = tileset->GetTileHeight();
+  bool ok = buf->data.empty() || fwrite(&buf->data[0], 1, buf->data.size(), fp) == buf->data.size();
+  if (fclose(fp) != 0) {
+    ok = false;
+  }
 
-  int max_tiles_x = w / tw;
-  int max_tiles_y = h / th;
+  if (!ok) {
+    printf("error: unable to write level file\n");
+  }
 
-  return max_tiles_x * max_tiles_y;
+  return ok;
 }
 
-enum object_type get_object_type(const char *str)
-{
-  enum object_type type;
-
-  if (strcmp(str, "enemy") == 0)
-    type = OBJECT_TYPE_ENEMY;
-  else if (strcmp(str, "boss") == 0)
-    type = OBJECT_TYPE_BOSS;
-  else if (strcmp(str, "item") == 0)
-    type = OBJECT_TYPE_ITEM;
-  else if (strcmp(str, "savetube") == 0)
-    type = OBJECT_TYPE_SAVETUBE;
-  else if (strcmp(str, "light") == 0)
-    type = OBJECT_TYPE_LIGHT;
-  else if (strcmp(str, "npc") == 0)
-    type = OBJECT_TYPE_NPC;
-  else if (strcmp(str, "static") == 0)
-    type = OBJECT_TYPE_STATIC;
-  else
-    type = OBJECT_TYPE_UNKNOWN;
-
-  return type;
-}
-enum direction get_direction(const char *str)
+// Messages of the conversion go to the console
+static void log_console(const char *text, void *user)
 {
-  enum direction dir;
-
-  if (strcmp(str, "N") == 0)
-    dir = N;
-  else if (strcmp(str, "W") == 0)
-    dir = W;
-  else if (strcmp(str, "S") == 0)
-    dir = S;
-  else if (strcmp(str, "E") == 0)
-    dir = E;
-  else if (strcmp(str, "NW") == 0)
-    dir = NW;
-  else if (strcmp(str, "SW") == 0)
-    dir = SW;
-  else if (strcmp(str, "NE") == 0)
-    dir = NE;
-  else if (strcmp(str, "SE") == 0)
-    dir = SE;
-  else
-    dir = MAX_DIRECTION;
-
-  return dir;
+  fputs(text, stdout);
 }
 
-enum area_type get_area_type(const char *str)
+int print_info(const char *filename)
 {
-  enum area_type type;
-
-  if (strcmp(str, "door") == 0)
-    type = AREA_TYPE_DOOR;
-  else if (strcmp(str, "damage") == 0)
-    type = AREA_TYPE_DAMAGE;
-  else if (strcmp(str, "trigger") == 0)
-    type = AREA_TYPE_TRIGGER;
-  else
-    type = AREA_TYPE_UNKNOWN;
-
-  return type;
-}
-
-int main(int argc, char **argv) {
-  int data_size = 2;
-  bool vertical = false;
-  bool legacy = false;
-  bool bottom = false;
+  Tmx::MapInfo info;
+  info.ParseFile(filename);
 
-  if (argc < 3) {
-    printf("Usage is: %s <tmxfile> <binfile> [--datasize 1|2] [--vertical]\n", argv[0]);
-    return 1;
+  if (info.HasError()) {
+    printf("error code: %d\n", info.GetErrorCode());
+    printf("error text: %s\n", info.GetErrorText().c_str());
+    return info.GetErrorCode();
   }
 
-  if (argc > 3) {
-    for (int i = 3; i < argc; i++) {
-      if (strcmp(argv[i], "--datasize") == 0) {
-        data_size = atoi(argv[i + 1]);
-        if (data_size < 1) {
-          data_size = 1;
-        }
-        else if (data_size > 2) {
-          data_size = 2;
-        }
-      }
-      else if (strcmp(argv[i], "--vertical") == 0) {
-        vertical = true;
-      }
-      else if (strcmp(argv[i], "--legacy") == 0) {
-        legacy = true;
-      }
-      else if (strcmp(argv[i], "--bottom") == 0) {
-        bottom = true;
-      }
+  printf("file: %s\n", filename);
+  printf("version: %1.1f\n", info.GetVersion());
+  printf("orientation: %s\n", info.GetOrientation() == Tmx::TMX_MO_ORTHOGONAL ? "orthogonal" : "isometric");
+  printf("size: %dx%d%s\n", info.GetWidth(), info.GetHeight(), info.IsInfinite() ? " infinite" : "");
+  printf("tile size: %dx%d\n", info.GetTileWidth(), info.GetTileHeight());
+
+  const std::vector<Tmx::TilesetInfo> &tilesets = info.GetTilesets();
+  for (unsigned int i = 0; i < tilesets.size(); i++) {
+    if (tilesets[i].source.empty()) {
+      printf("tileset: %d \"%s\"\n", tilesets[i].firstGid, tilesets[i].name.c_str());
+    }
+    else {
+      printf("tileset: %d source %s\n", tilesets[i].firstGid, tilesets[i].source.c_str());
     }
   }
 
-  printf("converting file: %s\n", argv[1]);
-  Tmx::Map *map = new Tmx::Map();
-  map->ParseFile(argv[1]);
+  const std::vector<std::string> &layers = info.GetLayerNames();
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    printf("layer: %s\n", layers[i].c_str());
+  }
 
-  if (map->HasError()) {
-    printf("error code: %d\n", map->GetErrorCode());
-    printf("error text: %s\n", map->GetErrorText().c_str());
-    return map->GetErrorCode();
+  const std::vector<std::string> &groups = info.GetObjectGroupNames();
+  for (unsigned int i = 0; i < groups.size(); i++) {
+    printf("object group: %s\n", groups[i].c_str());
   }
 
-  printf("Version: %1.1f\n", map->GetVersion());
+  return 0;
+}
+
+// Returns true if the file at cache_name exists and is newer than file_name
+static bool cache_is_fresh(const char *file_name, const char *cache_name)
+{
+  struct stat src, dst;
 
-  if (map->GetOrientation() != Tmx::TMX_MO_ORTHOGONAL) {
-    printf("error: map orientation must be orthogonal\n");
-    return 1;
+  if (stat(file_name, &src) != 0 || stat(cache_name, &dst) != 0) {
+    return false;
   }
 
-  FILE *fp = fopen(argv[2], "wb");
-  if (fp == NULL) {
-    printf("error: unable to create file %s\n", argv[2]);
-    return 1;
+  if (dst.st_mtim.tv_sec != src.st_mtim.tv_sec) {
+    return dst.st_mtim.tv_sec > src.st_mtim.tv_sec;
   }
 
-  const Tmx::Tileset *tileset = map->GetTileset(0);
-  if (!tileset) {
-    printf("error - no tileset exist\n");
-    return 1;
-  }
+  return dst.st_mtim.tv_nsec > src.st_mtim.tv_nsec;
+}
 
-  int num_tiles = get_max_tiles(tileset);
-  printf("Number of tiles: %d\n", num_tiles);
-  if (data_size == 2) {
-    printf("2-byte per tile\n");
-    if (!legacy) {
-      write_word((short) num_tiles, fp);
-    }
-  }
-  else {
-    printf("1-byte per tile\n");
-    if (!legacy) {
-      fputc((char) num_tiles, fp);
+// Check that the cache was written after every external tileset of the map it holds
+static bool tilesets_are_fresh(const Tmx::Map *map, const char *cache_name)
+{
+  for (int i = 0; i < map->GetNumTilesets(); i++) {
+    const std::string &source = map->GetTileset(i)->GetSource();
+    if (!source.empty() && !cache_is_fresh(source.c_str(), cache_name)) {
+      return false;
     }
   }
 
-  if (!legacy) {
-    std::vector<Tmx::Tile*> tiles = tileset->GetTiles();
-    for (int i = 0; i < num_tiles; i++) {
+  return true;
+}
 
-      std::string value;
-      std::string mask_string;
-      char type = TILE_TYPE_NONE;
-      short mask = 0x0000;
+// Parse the map, going through the snapshot cache when one is given
+static Tmx::Map *load_map(const char *file_name, const char *cache_name)
+{
+  Tmx::Map *map = new Tmx::Map();
 
-      for (unsigned int j = 0; j < tiles.size(); j++) {
+  if (cache_name && cache_is_fresh(file_name, cache_name)) {
+    map->LoadSnapshot(cache_name);
+    if (!map->HasError() && tilesets_are_fresh(map, cache_name)) {
+      printf("loaded snapshot: %s\n", cache_name);
+      return map;
+    }
 
-        Tmx::Tile *tile = tiles[j];
-        if (i == tile->GetId()) {
+    if (map->HasError()) {
+      printf("ignoring snapshot: %s\n", map->GetErrorText().c_str());
+    }
+    else {
+      printf("ignoring snapshot: an external tileset changed\n");
+    }
+    delete map;
+    map = new Tmx::Map();
+  }
 
-          const Tmx::PropertySet prop = tile->GetProperties();
-          value = prop.GetLiteralProperty(std::string("type"));
+  map->ParseFile(file_name);
 
-          type = get_tile_type(value.c_str());
-          if (type == TILE_TYPE_OVERLAY) {
-            std::string value = prop.GetLiteralProperty(std::string("bg_tile"));
-            char bg = (char) atoi(value.c_str());
-            bg <<= 1;
-            type |= bg;
-          }
+  if (cache_name && !map->HasError()) {
+    if (!map->SaveSnapshot(cache_name)) {
+      printf("could not write snapshot: %s\n", cache_name);
+    }
+  }
 
-          mask_string = prop.GetLiteralProperty(std::string("mask"));
-          mask = strtol(mask_string.c_str(), NULL, 16);
+  return map;
+}
 
-          printf("tile: %d %s(0x%x) %s(0x%x)\n", i, value.c_str(), type & 0xFF, mask_string.c_str(), mask & 0xFFFF);
-          break;
-        }
+// Parse every map of a world, check the doors linking its levels and write the world index
+static int convert_world(const char *index_name, int num_files, char **file_names)
+{
+  std::vector<std::string> files(file_names, file_names + num_files);
+  std::vector<world_level> levels;
+
+  convert_log log = { log_console, NULL };
+  printf("converting world: %d level(s)\n", num_files);
+  if (!world_load(&levels, files, "areas")) {
+    for (unsigned int i = 0; i < levels.size(); i++) {
+      if (!levels[i].error.empty()) {
+        printf("error: level %d: %s: %s\n", i, levels[i].file_name.c_str(), levels[i].error.c_str());
       }
-
-      fputc(type, fp);
-      write_word(mask, fp);
     }
+    return 1;
   }
 
-  const int num_layers = map->GetNumLayers();
-  if (num_layers <= 0) {
-    printf("error: no layers exist\n");
-    return 1;
+  int num_doors = 0;
+  for (unsigned int i = 0; i < levels.size(); i++) {
+    printf("Level %d: %s %dx%d, %d door(s)\n", i, levels[i].file_name.c_str(), levels[i].width, levels[i].height, (int) levels[i].doors.size());
+    num_doors += levels[i].doors.size();
   }
 
-  const Tmx::Layer *layer = map->GetLayer(0);
-  if (!layer) {
-    printf("error: layer zero does not exist\n");
+  const int problems = world_validate(levels, &log);
+  if (problems) {
+    printf("error: %d problem(s) with the doors of the world\n", problems);
     return 1;
   }
 
-  short w = (short) layer->GetWidth();
-  short h = (short) layer->GetHeight();
-
-  printf("Map size: %dx%d\n", w, h);
+  lev_buffer level_buf;
+  lev_buffer door_buf;
+  world_write_index(levels, &level_buf, &door_buf);
 
-  write_word(w, fp);
-  write_word(h, fp);
+  std::vector<lev_section> sections;
+  lev_section level_section = { LEV_SECTION_WORLD_LEVELS, 0, &level_buf };
+  lev_section door_section = { LEV_SECTION_WORLD_DOORS, 0, &door_buf };
+  sections.push_back(level_section);
+  sections.push_back(door_section);
 
-  for (int i = 0; i < num_layers; i++) {
+  printf("World: %d level(s), %d door(s)\n", (int) levels.size(), num_doors);
+  printf("Writing %d section(s) to container\n", (int) sections.size());
 
-    printf("Layer %d/%d\n", i + 1, num_layers);
-    const Tmx::Layer *layer = map->GetLayer(i);
-    if (!layer) {
-      printf("error: layer %d does not exist\n", i);
-      return 1;
-    }
+  lev_buffer out;
+  lev_build_container(sections, &out);
+  return write_file(index_name, &out) ? 0 : 1;
+}
 
-    if (vertical) {
-      for (int x = 0; x < w; x++) {
-        for (int y = 0; y < h; y++) {
-          if (data_size == 2) {
-            short tile_id = (short) layer->GetTileId(x, y);
-            write_word(tile_id, fp);
-          }
-          else {
-            char tile_id = (char) layer->GetTileId(x, y);
-            fputc(tile_id, fp);
-          }
-        }
-      }
-    }
-    else {
-      for (int y = 0; y < h; y++) {
-        for (int x = 0; x < w; x++) {
-          if (data_size == 2) {
-            short tile_id = (short) layer->GetTileId(x, y);
-            write_word(tile_id, fp);
-          }
-          else {
-            char tile_id = (char) layer->GetTileId(x, y);
-            fputc(tile_id, fp);
-          }
-        }
-      }
-    }
+int main(int argc, char **argv) {
+  if (argc == 3 && strcmp(argv[1], "--info") == 0) {
+    return print_info(argv[2]);
   }
 
-  if (legacy) {
-    return 0;
+  if (argc >= 4 && strcmp(argv[1], "--world") == 0) {
+    return convert_world(argv[2], argc - 3, argv + 3);
   }
 
-  const int num_groups = map->GetNumObjectGroups();
-  if (num_groups > 0)
-  {
-    printf("Found %d object group(s)\n", num_groups);
-
-    int objects_index = -1;
-    for (int i = 0; i < num_groups; i++)
-    {
-      const Tmx::ObjectGroup *group = map->GetObjectGroup(i);
-      if (strcmp(group->GetName().c_str(), "objects") == 0)
-      {
-        objects_index = i;
-        break;
-      }
-    }
-
-    if (objects_index >= 0)
-    {
-      const Tmx::ObjectGroup *group = map->GetObjectGroup(objects_index);
-      const int num_objects = group->GetNumObjects();
-
-      if (num_objects > 0)
-      {
-        printf("%s has %d object(s)\n", group->GetName().c_str(), num_objects);
-        write_word((short) num_objects, fp);
-
-        for (int j = 0; j < num_objects; j++)
-        {
-          const Tmx::Object *object = group->GetObject(j);
-
-          const std::string type_name = object->GetType();
-          enum object_type object_type = get_object_type(type_name.c_str());
-
-          const Tmx::PropertySet prop = object->GetProperties();
-          int index = prop.GetNumericProperty(std::string("index"));
-          std::string dir_name = prop.GetLiteralProperty(std::string("direction"));
-          int param = prop.GetNumericProperty(std::string("param"));
-          enum direction dir = get_direction(dir_name.c_str());
-
-          int obj_y;
-          if (!bottom)
-          {
-            obj_y = object->GetY();
-          }
-          else
-          {
-            obj_y = object->GetY() + object->GetHeight();
-          }
-
-          printf("\t%s(%d) - \"%s\" index=%d at: (%d, %d), facing %d(%s), param=%d\n", type_name.c_str(), object_type, object->GetName().c_str(), index, object->GetX(), obj_y, dir, dir_name.c_str(), param);
-
-          fputc((char) object_type, fp);
-          fputc((char) index, fp);
-          fputc((char) dir, fp);
-          fputc((char) param, fp);
-          write_word((short) object->GetX(), fp);
-          write_word((short) obj_y, fp);
-
-          if (object_type == OBJECT_TYPE_NPC)
-          {
-            const Tmx::Polyline *polyline = object->GetPolyline();
-            if (polyline)
-            {
-              fputc((char) polyline->GetNumPoints(), fp);
-              printf("Polyline[%d]: ", polyline->GetNumPoints());
-              for (int p = 0; p < polyline->GetNumPoints(); p++)
-              {
-                const Tmx::Point point = polyline->GetPoint(p);
-                write_word((short) point.x, fp);
-                write_word((short) point.y, fp);
-                printf("(%d, %d) ", point.x, point.y);
-              }
-              printf("\n");
-            }
-            else
-            {
-              printf("No polyline\n");
-              fputc(0, fp);
-            }
-          }
-        }
-      }
-    }
-    else
-    {
-      printf("No objects\n");
-      write_word((short) 0, fp);
-    }
+  if (argc < 3) {
+    printf("Usage is: %s <tmxfile> <binfile> [--datasize 1|2|auto] [--vertical] [--collision 1|16] [--area-grid <tiles>] [--strips <pixels>] [--container] [--compact-paths] [--chunks] [--cache <file>] [--verbose]\n", argv[0]);
+    printf("       [--layers <name,...>] [--tileset <name>] [--objects <name>] [--areas <name>] [--flatten <pattern>] [--crop] [--spans] [--animations] [--lightmap <cells per tile>] [--nav] [--flow-fields] [--pvs <width>x<height>] [--polygons]\n");
+    printf("       %s --info <tmxfile>\n", argv[0]);
+    printf("       %s --world <indexfile> <tmxfile>...\n", argv[0]);
+    return 1;
+  }
 
+  convert_log log = { log_console, NULL };
+  convert_options opts;
+  convert_options_init(&opts);
+  if (!convert_parse_options(&opts, argc - 3, argv + 3, &log)) {
+    return 1;
+  }
 
-    int areas_index = -1;
-    for (int i = 0; i < num_groups; i++)
-    {
-      const Tmx::ObjectGroup *group = map->GetObjectGroup(i);
-      if (strcmp(group->GetName().c_str(), "areas") == 0)
-      {
-        areas_index = i;
-        break;
-      }
-    }
+  printf("converting file: %s\n", argv[1]);
+  Tmx::Map *map = load_map(argv[1], opts.cache_name);
 
-    if (areas_index >= 0)
-    {
-      const Tmx::ObjectGroup *group = map->GetObjectGroup(areas_index);
-      const int num_objects = group->GetNumObjects();
-      if (num_objects > 0)
-      {
-        printf("%s has %d object(s)\n", group->GetName().c_str(), num_objects);
-        write_word((short) num_objects, fp);
-
-        for (int j = 0; j < num_objects; j++)
-        {
-          const Tmx::Object *object = group->GetObject(j);
-
-          const std::string type_name = object->GetType();
-          enum area_type area_type = get_area_type(type_name.c_str());
-
-          const Tmx::PropertySet prop = object->GetProperties();
-          int level = prop.GetNumericProperty(std::string("level"));
-          int start_x = prop.GetNumericProperty(std::string("start_x"));
-          int start_y = prop.GetNumericProperty(std::string("start_y"));
-          std::string dir_name = prop.GetLiteralProperty(std::string("direction"));
-          enum direction dir = get_direction(dir_name.c_str());
-
-          printf("\t%s(%d) - \"%s\" at: (%d, %d) size(%d x %d), level %d, start (%d, %d), facing %d(%s)\n", type_name.c_str(), area_type, object->GetName().c_str(), object->GetX(), object->GetY(), object->GetWidth(), object->GetHeight(), level, start_x, start_y, dir, dir_name.c_str());
-
-          fputc((char) area_type, fp);
-          write_word((short) level, fp);
-          write_word((short) start_x, fp);
-          write_word((short) start_y, fp);
-          fputc((char) dir, fp);
-          write_word((short) object->GetX(), fp);
-          write_word((short) object->GetY(), fp);
-          write_word((short) object->GetWidth(), fp);
-          write_word((short) object->GetHeight(), fp);
-        }
-      }
-    }
-    else
-    {
-      printf("No areas\n");
-      write_word((short) 0, fp);
-    }
+  if (map->HasError()) {
+    printf("error code: %d\n", map->GetErrorCode());
+    printf("error text: %s\n", map->GetErrorText().c_str());
+    return map->GetErrorCode();
   }
-  else
-  {
-    printf("No object group(s) defined\n");
-    write_word((short) 0, fp);
-    write_word((short) 0, fp);
+
+  lev_buffer out;
+  const int result = convert_level(map, &opts, &out, &log);
+  if (result != 0) {
+    return result;
   }
 
-  return 0;
+  return write_file(argv[2], &out) ? 0 : 1;
 }
-
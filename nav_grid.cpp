@@ -0,0 +1,130 @@
+#include <limits.h>
+#include "nav_grid.h"
+
+// Flow fields worth a thread of their own
+#define NAV_MIN_FIELDS 1
+
+static const int step_x[NAV_NUM_DIRECTIONS] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+static const int step_y[NAV_NUM_DIRECTIONS] = { -1, 0, 1, 0, -1, 1, -1, 1 };
+static const int opposite[NAV_NUM_DIRECTIONS] = { 2, 3, 0, 1, 7, 6, 5, 4 };
+
+// Straight and diagonal step costs, the largest must stay below the number of buckets
+#define NAV_STRAIGHT_COST 2
+#define NAV_DIAGONAL_COST 3
+#define NAV_BUCKETS       4
+
+void nav_grid_build(nav_grid *grid, const std::vector<const Tmx::Layer *> &layers,
+                    const std::vector<tile_attr> &attrs, int width, int height)
+{
+  grid->width = width;
+  grid->height = height;
+  grid->fields.clear();
+
+  std::vector<unsigned char> solid;
+  collision_solid(&solid, layers, attrs, width, height);
+
+  grid->walkable.assign(width * height, 0);
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    const Tmx::Layer *layer = layers[i];
+
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        if (layer->GetTileTilesetIndex(x, y) >= 0 && !solid[y * width + x]) {
+          grid->walkable[y * width + x] = 1;
+        }
+      }
+    }
+  }
+}
+
+// Dijkstra from the cells of the target over a circular bucket queue, costs being small integers
+static void build_field(std::vector<unsigned char> *field, const nav_grid *grid, const nav_target &target)
+{
+  const int width = grid->width;
+  const int height = grid->height;
+
+  std::vector<int> dist(width * height, INT_MAX);
+  std::vector<int> buckets[NAV_BUCKETS];
+  int pending = 0;
+
+  field->assign(width * height, NAV_NO_DIRECTION);
+
+  for (int y = target.y; y < target.y + target.height; y++) {
+    for (int x = target.x; x < target.x + target.width; x++) {
+      if (nav_walkable(grid, x, y)) {
+        dist[y * width + x] = 0;
+        buckets[0].push_back(y * width + x);
+        pending++;
+      }
+    }
+  }
+
+  for (int cost = 0; pending > 0; cost++) {
+    std::vector<int> &bucket = buckets[cost % NAV_BUCKETS];
+
+    while (!bucket.empty()) {
+      const int cell = bucket.back();
+      bucket.pop_back();
+      pending--;
+
+      if (dist[cell] != cost) {
+        continue;
+      }
+
+      const int x = cell % width;
+      const int y = cell / width;
+      for (int d = 0; d < NAV_NUM_DIRECTIONS; d++) {
+        const int nx = x + step_x[d];
+        const int ny = y + step_y[d];
+        if (!nav_walkable(grid, nx, ny)) {
+          continue;
+        }
+
+        const bool diagonal = step_x[d] != 0 && step_y[d] != 0;
+        if (diagonal && (!nav_walkable(grid, nx, y) || !nav_walkable(grid, x, ny))) {
+          continue;
+        }
+
+        const int next = ny * width + nx;
+        const int next_cost = cost + (diagonal ? NAV_DIAGONAL_COST : NAV_STRAIGHT_COST);
+        if (next_cost < dist[next]) {
+          dist[next] = next_cost;
+          (*field)[next] = (unsigned char) opposite[d];
+          buckets[next_cost % NAV_BUCKETS].push_back(next);
+          pending++;
+        }
+      }
+    }
+  }
+}
+
+void nav_flow_fields(nav_grid *grid, const std::vector<nav_target> &targets)
+{
+  const int num_fields = targets.size();
+  grid->fields.resize(num_fields);
+
+  const int num_tasks = Tmx::Util::GetNumTasks(num_fields, NAV_MIN_FIELDS);
+  Tmx::Util::ParallelFor(num_tasks, [&](int task) {
+    for (int i = task; i < num_fields; i += num_tasks) {
+      build_field(&grid->fields[i], grid, targets[i]);
+    }
+  });
+}
+
+bool nav_walkable(const nav_grid *grid, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= grid->width || y >= grid->height) {
+    return false;
+  }
+
+  return grid->walkable[y * grid->width + x] != 0;
+}
+
+int nav_direction(const nav_grid *grid, int field, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= grid->width || y >= grid->height) {
+    return NAV_NO_DIRECTION;
+  }
+
+  return grid->fields[field][y * grid->width + x];
+}
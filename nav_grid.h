@@ -0,0 +1,56 @@
+#ifndef _NAV_GRID_H
+#define _NAV_GRID_H
+
+#include <vector>
+#include "collision.h"
+
+// Directions follow the direction enum of the objects: N, W, S, E, NW, SW, NE, SE
+#define NAV_NUM_DIRECTIONS 8
+// Direction of cells that are a target or can not reach it
+#define NAV_NO_DIRECTION   8
+
+// Kind of point enemies are led to
+enum nav_target_kind
+{
+  NAV_TARGET_SAVETUBE = 1,
+  NAV_TARGET_DOOR
+};
+
+// Cells of a target, in tiles, with the index of its object or area
+struct nav_target
+{
+  int kind;
+  int index;
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// Walkable cells of a map and one flow field per target
+struct nav_grid
+{
+  int width;
+  int height;
+  std::vector<unsigned char> walkable;
+
+  // Per target, the direction of the next step on a shortest path from every cell
+  std::vector<std::vector<unsigned char> > fields;
+};
+
+// Find the cells holding a tile in some layer and no rock or metal tile in any
+void nav_grid_build(nav_grid *grid, const std::vector<const Tmx::Layer *> &layers,
+                    const std::vector<tile_attr> &attrs, int width, int height);
+
+// Compute the flow field of every target, several targets in parallel. Paths move
+// in eight directions without cutting corners of blocked cells, a diagonal step costing
+// one and a half straight steps.
+void nav_flow_fields(nav_grid *grid, const std::vector<nav_target> &targets);
+
+// Get whether cell (x, y) is walkable, false outside the map
+bool nav_walkable(const nav_grid *grid, int x, int y);
+
+// Get the direction of the next step from cell (x, y) toward a target
+int nav_direction(const nav_grid *grid, int field, int x, int y);
+
+#endif
@@ -0,0 +1,117 @@
+#include "path_codec.h"
+
+static bool fits_delta(int value)
+{
+  return value >= PATH_DELTA_MIN && value <= 127;
+}
+
+int path_encode(const std::vector<Tmx::Point> &points, lev_buffer *buf)
+{
+  const int start = buf->data.size();
+
+  write_word((short) points.size(), buf);
+  if (points.empty()) {
+    return buf->data.size() - start;
+  }
+
+  write_word((short) points[0].x, buf);
+  write_word((short) points[0].y, buf);
+
+  for (unsigned int i = 1; i < points.size(); i++) {
+    const int dx = (short) points[i].x - (short) points[i - 1].x;
+    const int dy = (short) points[i].y - (short) points[i - 1].y;
+
+    if (fits_delta(dx) && dy >= -128 && dy <= 127) {
+      write_byte(dx, buf);
+      write_byte(dy, buf);
+    }
+    else if (dy == 0) {
+      write_byte(PATH_CODE_X16, buf);
+      write_word((short) dx, buf);
+    }
+    else if (dx == 0) {
+      write_byte(PATH_CODE_Y16, buf);
+      write_word((short) dy, buf);
+    }
+    else {
+      write_byte(PATH_CODE_XY16, buf);
+      write_word((short) dx, buf);
+      write_word((short) dy, buf);
+    }
+  }
+
+  return buf->data.size() - start;
+}
+
+static short read_word(const unsigned char *p)
+{
+  return (short) ((p[0] << 8) | p[1]);
+}
+
+int path_decode(const unsigned char *data, int size, std::vector<Tmx::Point> *points)
+{
+  points->clear();
+  if (size < 2) {
+    return -1;
+  }
+
+  const int num_points = (unsigned short) read_word(data);
+  int pos = 2;
+  if (num_points == 0) {
+    return pos;
+  }
+
+  if (pos + 4 > size) {
+    return -1;
+  }
+
+  Tmx::Point point;
+  point.x = read_word(data + pos);
+  point.y = read_word(data + pos + 2);
+  pos += 4;
+  points->push_back(point);
+
+  for (int i = 1; i < num_points; i++) {
+    if (pos >= size) {
+      return -1;
+    }
+
+    int dx = 0;
+    int dy = 0;
+    const unsigned char code = data[pos++];
+
+    if (code == PATH_CODE_X16 || code == PATH_CODE_Y16) {
+      if (pos + 2 > size) {
+        return -1;
+      }
+      if (code == PATH_CODE_X16) {
+        dx = read_word(data + pos);
+      }
+      else {
+        dy = read_word(data + pos);
+      }
+      pos += 2;
+    }
+    else if (code == PATH_CODE_XY16) {
+      if (pos + 4 > size) {
+        return -1;
+      }
+      dx = read_word(data + pos);
+      dy = read_word(data + pos + 2);
+      pos += 4;
+    }
+    else {
+      if (pos + 1 > size) {
+        return -1;
+      }
+      dx = (signed char) code;
+      dy = (signed char) data[pos++];
+    }
+
+    point.x = (short) (point.x + dx);
+    point.y = (short) (point.y + dy);
+    points->push_back(point);
+  }
+
+  return pos;
+}
@@ -0,0 +1,23 @@
+#ifndef _PATH_CODEC_H
+#define _PATH_CODEC_H
+
+#include <vector>
+#include "Tmx.h"
+#include "lev_file.h"
+
+// Compact path encoding:
+//   number of points (word), first point (two words), then one delta per following point:
+//   two signed bytes dx, dy with dx in [PATH_DELTA_MIN, 127], or one of the codes below
+#define PATH_CODE_X16   0x80  // horizontal segment, dx word follows
+#define PATH_CODE_Y16   0x81  // vertical segment, dy word follows
+#define PATH_CODE_XY16  0x82  // dx and dy words follow
+#define PATH_DELTA_MIN  -125
+#define PATH_MAX_POINTS 0xffff
+
+// Append the compact encoding of at most PATH_MAX_POINTS points to buf, returns the number of bytes written
+int path_encode(const std::vector<Tmx::Point> &points, lev_buffer *buf);
+
+// Decode a compact path, returns the number of bytes consumed or -1 if the data is truncated
+int path_decode(const unsigned char *data, int size, std::vector<Tmx::Point> *points);
+
+#endif
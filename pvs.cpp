@@ -0,0 +1,130 @@
+#include "Tmx.h"
+#include "pvs.h"
+
+// Rows of regions worth a thread of their own
+#define PVS_MIN_ROWS 2
+
+// Mark the cells of the window seen from the region, open cells spreading to their four
+// neighbours and solid cells being seen but stopping the spread
+static void flood_region(std::vector<unsigned char> *mark, std::vector<int> *stack, const std::vector<unsigned char> &solid,
+                         int width, int x0, int y0, int x1, int y1, int rx0, int ry0, int rx1, int ry1)
+{
+  static const int step_x[4] = { 0, -1, 0, 1 };
+  static const int step_y[4] = { -1, 0, 1, 0 };
+
+  const int win_width = x1 - x0;
+  mark->assign(win_width * (y1 - y0), 0);
+  stack->clear();
+
+  for (int y = ry0; y < ry1; y++) {
+    for (int x = rx0; x < rx1; x++) {
+      (*mark)[(y - y0) * win_width + (x - x0)] = 1;
+      if (!solid[y * width + x]) {
+        stack->push_back((y - y0) * win_width + (x - x0));
+      }
+    }
+  }
+
+  while (!stack->empty()) {
+    const int cell = stack->back();
+    stack->pop_back();
+
+    const int x = cell % win_width + x0;
+    const int y = cell / win_width + y0;
+    for (int d = 0; d < 4; d++) {
+      const int nx = x + step_x[d];
+      const int ny = y + step_y[d];
+      if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) {
+        continue;
+      }
+
+      const int next = (ny - y0) * win_width + (nx - x0);
+      if (!(*mark)[next]) {
+        (*mark)[next] = 1;
+        if (!solid[ny * width + nx]) {
+          stack->push_back(next);
+        }
+      }
+    }
+  }
+}
+
+void pvs_build(pvs_table *pvs, const std::vector<unsigned char> &solid, int width, int height,
+               int region_width, int region_height, const std::vector<pvs_object> &objects)
+{
+  pvs->region_width = region_width;
+  pvs->region_height = region_height;
+  pvs->cols = (width + region_width - 1) / region_width;
+  pvs->rows = (height + region_height - 1) / region_height;
+  pvs->num_objects = objects.size();
+  pvs->object_bytes = ((pvs->num_objects + 15) / 16) * 2;
+
+  const int num_regions = pvs->cols * pvs->rows;
+  pvs->masks.assign(num_regions, 0);
+  pvs->objects.assign(num_regions * pvs->object_bytes, 0);
+
+  const int num_tasks = Tmx::Util::GetNumTasks(pvs->rows, PVS_MIN_ROWS);
+  Tmx::Util::ParallelFor(num_tasks, [&](int task) {
+    const int row_begin = pvs->rows * task / num_tasks;
+    const int row_end = pvs->rows * (task + 1) / num_tasks;
+
+    std::vector<unsigned char> mark;
+    std::vector<int> stack;
+
+    for (int row = row_begin; row < row_end; row++) {
+      for (int col = 0; col < pvs->cols; col++) {
+        const int rx0 = col * region_width;
+        const int ry0 = row * region_height;
+        const int rx1 = rx0 + region_width < width ? rx0 + region_width : width;
+        const int ry1 = ry0 + region_height < height ? ry0 + region_height : height;
+
+        // The window is the region and its neighbours
+        const int x0 = rx0 - region_width > 0 ? rx0 - region_width : 0;
+        const int y0 = ry0 - region_height > 0 ? ry0 - region_height : 0;
+        const int x1 = rx1 + region_width < width ? rx1 + region_width : width;
+        const int y1 = ry1 + region_height < height ? ry1 + region_height : height;
+
+        flood_region(&mark, &stack, solid, width, x0, y0, x1, y1, rx0, ry0, rx1, ry1);
+
+        const int win_width = x1 - x0;
+        unsigned short mask = 0;
+        for (int y = y0; y < y1; y++) {
+          for (int x = x0; x < x1; x++) {
+            if (mark[(y - y0) * win_width + (x - x0)]) {
+              const int dx = x / region_width - col;
+              const int dy = y / region_height - row;
+              mask |= 1 << ((dy + 1) * 3 + (dx + 1));
+            }
+          }
+        }
+
+        const int region = row * pvs->cols + col;
+        pvs->masks[region] = mask;
+
+        unsigned char *bits = &pvs->objects[region * pvs->object_bytes];
+        for (int i = 0; i < pvs->num_objects; i++) {
+          // Objects off the map count as being on its nearest edge
+          const int x = objects[i].x < 0 ? 0 : objects[i].x >= width ? width - 1 : objects[i].x;
+          const int y = objects[i].y < 0 ? 0 : objects[i].y >= height ? height - 1 : objects[i].y;
+          if (x >= x0 && y >= y0 && x < x1 && y < y1 && mark[(y - y0) * win_width + (x - x0)]) {
+            bits[i / 8] |= 0x80 >> (i & 7);
+          }
+        }
+      }
+    }
+  });
+}
+
+unsigned short pvs_region_mask(const pvs_table *pvs, int col, int row)
+{
+  return pvs->masks[row * pvs->cols + col];
+}
+
+const unsigned char *pvs_region_objects(const pvs_table *pvs, int col, int row)
+{
+  if (pvs->object_bytes == 0) {
+    return NULL;
+  }
+
+  return &pvs->objects[(row * pvs->cols + col) * pvs->object_bytes];
+}
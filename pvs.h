@@ -0,0 +1,45 @@
+#ifndef _PVS_H
+#define _PVS_H
+
+#include <vector>
+
+// Position of an object, in tiles
+struct pvs_object
+{
+  int x;
+  int y;
+};
+
+// Regions and objects potentially visible from every screen-sized region of a map.
+// A camera inside a region only shows parts of it and its eight neighbours, so the regions
+// seen from a region are a mask of nine bits, bit (dy + 1) * 3 + (dx + 1) for neighbour (dx, dy).
+struct pvs_table
+{
+  int region_width;
+  int region_height;
+  int cols;
+  int rows;
+  int num_objects;
+
+  // Bytes of the object bitset of one region, kept even so the next region stays word aligned
+  int object_bytes;
+
+  std::vector<unsigned short> masks;
+  std::vector<unsigned char> objects;
+};
+
+// Find what may be seen from every region of a width x height map. Cells are treated as
+// seen when a path of open cells leads to them from the region without leaving its
+// neighbourhood, which holds for every clear line of sight, so nothing visible is left out.
+// Rows of regions are processed in parallel.
+void pvs_build(pvs_table *pvs, const std::vector<unsigned char> &solid, int width, int height,
+               int region_width, int region_height, const std::vector<pvs_object> &objects);
+
+// Get the mask of the neighbours of region (col, row) that may be seen from it
+unsigned short pvs_region_mask(const pvs_table *pvs, int col, int row);
+
+// Get the object bitset of region (col, row), object i being bit 7 - i % 8 of byte i / 8,
+// NULL without objects
+const unsigned char *pvs_region_objects(const pvs_table *pvs, int col, int row);
+
+#endif
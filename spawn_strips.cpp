@@ -0,0 +1,53 @@
+#include <algorithm>
+#include "spawn_strips.h"
+
+struct position_less
+{
+  const std::vector<int> *positions;
+
+  bool operator()(int a, int b) const
+  {
+    return (*positions)[a] < (*positions)[b];
+  }
+};
+
+void spawn_sort(std::vector<int> *order, const std::vector<int> &positions)
+{
+  order->resize(positions.size());
+  for (unsigned int i = 0; i < positions.size(); i++) {
+    (*order)[i] = i;
+  }
+
+  position_less less = { &positions };
+  std::stable_sort(order->begin(), order->end(), less);
+}
+
+void spawn_strips_build(std::vector<spawn_strip> *strips, const std::vector<int> &order, const std::vector<int> &positions, int strip_size, int extent)
+{
+  int num_strips = (extent + strip_size - 1) / strip_size;
+  if (num_strips < 1) {
+    num_strips = 1;
+  }
+
+  spawn_strip empty = { 0, 0 };
+  strips->assign(num_strips, empty);
+
+  // Objects left of or beyond the map belong to the first or last strip
+  for (unsigned int i = 0; i < order.size(); i++) {
+    int strip = positions[order[i]] / strip_size;
+    if (positions[order[i]] < 0) {
+      strip = 0;
+    }
+    else if (strip >= num_strips) {
+      strip = num_strips - 1;
+    }
+
+    (*strips)[strip].count++;
+  }
+
+  int first = 0;
+  for (int i = 0; i < num_strips; i++) {
+    (*strips)[i].first = first;
+    first += (*strips)[i].count;
+  }
+}
@@ -0,0 +1,19 @@
+#ifndef _SPAWN_STRIPS_H
+#define _SPAWN_STRIPS_H
+
+#include <vector>
+
+// Range of sorted objects whose scroll position falls within one strip
+struct spawn_strip
+{
+  int first;
+  int count;
+};
+
+// Get the object indices ordered by position along the scroll axis, keeping document order for ties
+void spawn_sort(std::vector<int> *order, const std::vector<int> &positions);
+
+// Split objects sorted by spawn_sort into strips of strip_size pixels covering extent pixels
+void spawn_strips_build(std::vector<spawn_strip> *strips, const std::vector<int> &order, const std::vector<int> &positions, int strip_size, int extent);
+
+#endif
@@ -0,0 +1,51 @@
+#include <chrono>
+#include "test_util.h"
+#include "area_grid.h"
+
+// Time point queries through the grid against the linear scan, for growing numbers of areas
+int main()
+{
+  const int map_width = 4096;
+  const int map_height = 4096;
+  const int num_queries = 1000000;
+  const int counts[] = { 16, 64, 256, 1024, 4096 };
+
+  printf("%8s %12s %12s %8s\n", "areas", "scan ns/q", "grid ns/q", "speedup");
+  for (unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+    unsigned seed = 3;
+    std::vector<area_rect> areas;
+    for (int i = 0; i < counts[c]; i++) {
+      area_rect area = { (int) (test_rand(&seed) % map_width), (int) (test_rand(&seed) % map_height), 32 + (int) (test_rand(&seed) % 96), 32 + (int) (test_rand(&seed) % 96) };
+      areas.push_back(area);
+    }
+
+    area_grid grid;
+    area_grid_build(&grid, areas, map_width, map_height, 128, 128);
+
+    std::vector<int> points(num_queries * 2);
+    for (int i = 0; i < num_queries * 2; i += 2) {
+      points[i] = (test_rand(&seed) << 15 | test_rand(&seed)) % map_width;
+      points[i + 1] = (test_rand(&seed) << 15 | test_rand(&seed)) % map_height;
+    }
+
+    int result[64];
+    long total_scan = 0;
+    long total_grid = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_queries * 2; i += 2) {
+      total_scan += area_list_query(areas, points[i], points[i + 1], result, 64);
+    }
+    std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_queries * 2; i += 2) {
+      total_grid += area_grid_query(&grid, areas, points[i], points[i + 1], result, 64);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    const double scan_ns = std::chrono::duration<double, std::nano>(mid - start).count() / num_queries;
+    const double grid_ns = std::chrono::duration<double, std::nano>(end - mid).count() / num_queries;
+    printf("%8d %12.1f %12.1f %7.1fx%s\n", counts[c], scan_ns, grid_ns, scan_ns / grid_ns, total_scan == total_grid ? "" : "  MISMATCH");
+  }
+
+  return 0;
+}
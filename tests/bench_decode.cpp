@@ -0,0 +1,66 @@
+#include <chrono>
+#include <thread>
+#include "test_util.h"
+#include "TmxUtil.h"
+#include "base64.h"
+
+// Time the csv and base64 decode of a large layer for growing thread counts.
+// The size defaults to 8192x8192 tiles and can be given as the first argument.
+int main(int argc, char **argv)
+{
+  const int size = argc > 1 ? atoi(argv[1]) : 8192;
+  const int thread_counts[] = { 1, 2, 4, 8 };
+  unsigned seed = 31;
+
+  std::vector<unsigned> gids((size_t) size * size);
+  for (size_t i = 0; i < gids.size(); i++) {
+    gids[i] = (test_rand(&seed) % 4) ? test_rand(&seed) % 2000 + 1 : 0;
+  }
+
+  std::string csv;
+  csv.reserve(gids.size() * 5);
+  char number[16];
+  for (size_t i = 0; i < gids.size(); i++) {
+    snprintf(number, sizeof(number), i + 1 < gids.size() ? "%u," : "%u", gids[i]);
+    csv += number;
+  }
+
+  const std::string encodings[] = { "encoding=\"csv\"", "encoding=\"base64\"" };
+  const std::string payloads[] = { csv, base64_encode((const unsigned char *) &gids[0], gids.size() * 4) };
+  const char *names[] = { "csv", "base64" };
+  std::vector<unsigned>().swap(gids);
+  std::string().swap(csv);
+
+  printf("bench_decode: %dx%d layer, %u hardware thread(s)\n", size, size, std::thread::hardware_concurrency());
+  for (int e = 0; e < 2; e++) {
+    char head[512];
+    snprintf(head, sizeof(head), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             "<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"16\" tileheight=\"16\">\n"
+             "<tileset firstgid=\"1\" name=\"t\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"2000\"/>\n"
+             "<layer name=\"l\" width=\"%d\" height=\"%d\"><data %s>", size, size, size, size, encodings[e].c_str());
+    Tmx::Map *map = test_parse_map(head + payloads[e] + "</data></layer>\n</map>\n");
+
+    // Release drops the decoded tiles so the same payload can be decoded again
+    Tmx::Layer *layer = const_cast<Tmx::Layer *>(map->GetLayer(0));
+    double serial_ms = 0;
+    for (unsigned int t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+      layer->Release();
+      Tmx::Util::SetNumThreads(thread_counts[t]);
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      layer->Decode();
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+      const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+      if (t == 0) {
+        serial_ms = ms;
+      }
+      printf("  %-6s %2d thread(s) %9.1f ms %6.2fx\n", names[e], thread_counts[t], ms, serial_ms / ms);
+    }
+
+    Tmx::Util::SetNumThreads(0);
+    delete map;
+  }
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include <chrono>
+#include "test_util.h"
+#include "TmxUtil.h"
+
+#if defined(__AVX2__)
+#define GIDS_PATH "AVX2"
+#elif defined(__SSE2__)
+#define GIDS_PATH "SSE2"
+#else
+#define GIDS_PATH "scalar"
+#endif
+
+// Time the vector gid conversion against the scalar one for growing numbers of tilesets
+int main()
+{
+#if defined(__AVX2__)
+  if (!__builtin_cpu_supports("avx2")) {
+    printf("bench_gids (AVX2): skipped, not supported by this CPU\n");
+    return 0;
+  }
+#endif
+
+  const int count = 4 * 1024 * 1024;
+  const int repeats = 4;
+  const int num_tilesets[] = { 1, 2, 4, 8 };
+  unsigned seed = 17;
+
+  std::vector<unsigned> gids(count);
+  std::vector<Tmx::MapTile> tiles(count);
+
+  printf("bench_gids (" GIDS_PATH "): %d gids\n", count);
+  printf("%9s %14s %14s %8s\n", "tilesets", "scalar ns/gid", "vector ns/gid", "speedup");
+  for (unsigned int n = 0; n < sizeof(num_tilesets) / sizeof(num_tilesets[0]); n++) {
+    std::vector<int> first_gids;
+    for (int t = 0; t < num_tilesets[n]; t++) {
+      first_gids.push_back(1 + t * 256);
+    }
+
+    for (int i = 0; i < count; i++) {
+      gids[i] = test_rand(&seed) % (num_tilesets[n] * 256 + 1) | ((test_rand(&seed) & 7) << 29);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+      Tmx::Util::ConvertGidsScalar(&gids[0], count, first_gids, &tiles[0]);
+    }
+    std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+      Tmx::Util::ConvertGids(&gids[0], count, first_gids, &tiles[0]);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    const double scalar_ns = std::chrono::duration<double, std::nano>(mid - start).count() / count / repeats;
+    const double vector_ns = std::chrono::duration<double, std::nano>(end - mid).count() / count / repeats;
+    printf("%9d %14.2f %14.2f %7.2fx\n", num_tilesets[n], scalar_ns, vector_ns, scalar_ns / vector_ns);
+  }
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <thread>
+#include "test_util.h"
+#include "lightmap.h"
+
+// Time the bake of a map lit by hundreds of lights for growing thread counts.
+// The number of lights defaults to 500 and can be given as the first argument.
+int main(int argc, char **argv)
+{
+  const int num_lights = argc > 1 ? atoi(argv[1]) : 500;
+  const int width = 256;
+  const int height = 256;
+  const int subdiv = 4;
+  const int thread_counts[] = { 1, 2, 4, 8 };
+  unsigned seed = 43;
+
+  std::vector< std::vector<unsigned> > layers(1);
+  for (int i = 0; i < width * height; i++) {
+    layers[0].push_back(test_rand(&seed) % 100 < 8 ? 2 : 1);
+  }
+  const std::string tiles = test_tile_text(0, "floor", 0) + test_tile_text(1, "rock", 0xffff);
+  Tmx::Map *map = test_parse_map(test_map_text(width, height, 2, tiles, layers, ""));
+
+  std::vector<const Tmx::Layer *> layer_list(1, map->GetLayer(0));
+  std::vector<tile_attr> attrs;
+  tile_attrs_build(&attrs, map->GetTileset(0), get_max_tiles(map->GetTileset(0)));
+
+  std::vector<light_source> lights;
+  for (int i = 0; i < num_lights; i++) {
+    light_source light = { (int) (test_rand(&seed) % (width * 16)), (int) (test_rand(&seed) % (height * 16)), 4 + (int) (test_rand(&seed) % 9) };
+    lights.push_back(light);
+  }
+
+  printf("bench_lightmap: %dx%d tiles, %d cells per tile, %d light(s), %u hardware thread(s)\n",
+         width, height, subdiv, num_lights, std::thread::hardware_concurrency());
+
+  lightmap serial;
+  double serial_ms = 0;
+  for (unsigned int t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+    Tmx::Util::SetNumThreads(thread_counts[t]);
+
+    lightmap lmap;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    lightmap_build(&lmap, lights, layer_list, attrs, 16, 16, subdiv, 20);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (t == 0) {
+      serial_ms = ms;
+      serial.cells.swap(lmap.cells);
+    }
+    printf("  %2d thread(s) %9.1f ms %6.2fx%s\n", thread_counts[t], ms, serial_ms / ms,
+           t == 0 || lmap.cells == serial.cells ? "" : "  MISMATCH");
+  }
+
+  Tmx::Util::SetNumThreads(0);
+  delete map;
+
+  return 0;
+}
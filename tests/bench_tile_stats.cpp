@@ -0,0 +1,66 @@
+#include <chrono>
+#include "test_util.h"
+#include "tile_stats.h"
+
+// Time the tile statistics of a dense layer against gathering them cell by cell through GetTile
+int main()
+{
+  const int width = 2048;
+  const int height = 2048;
+  const int repeats = 4;
+  unsigned seed = 23;
+
+  std::vector< std::vector<unsigned> > layers(1);
+  for (int i = 0; i < width * height; i++) {
+    layers[0].push_back((test_rand(&seed) % 8) ? test_rand(&seed) % 4000 + 1 : 0);
+  }
+
+  Tmx::Map *map = test_parse_map(test_map_text(width, height, 4000, "", layers, ""));
+  const Tmx::Layer *layer = map->GetLayer(0);
+  layer->Decode();
+
+  // The statistics as they were gathered before, through GetTile for every cell
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  unsigned check = 0;
+  for (int r = 0; r < repeats; r++) {
+    unsigned min_id = ~0u;
+    unsigned max_id = 0;
+    int empty = 0;
+    int bins[TILE_STATS_BINS] = { 0 };
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        const Tmx::MapTile &tile = layer->GetTile(x, y);
+        if (tile.tilesetId < 0) {
+          empty++;
+          continue;
+        }
+
+        int bin = 0;
+        for (unsigned id = tile.id; id; id >>= 1) {
+          bin++;
+        }
+        min_id = tile.id < min_id ? tile.id : min_id;
+        max_id = tile.id > max_id ? tile.id : max_id;
+        bins[bin]++;
+      }
+    }
+    check += max_id + min_id + empty + bins[5];
+  }
+  std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+
+  tile_stats stats;
+  for (int r = 0; r < repeats; r++) {
+    tile_stats_build(&stats, layer, width, height);
+    check -= stats.max_id + stats.min_id + stats.empty + stats.bins[5];
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  const double loop_ns = std::chrono::duration<double, std::nano>(mid - start).count() / width / height / repeats;
+  const double stats_ns = std::chrono::duration<double, std::nano>(end - mid).count() / width / height / repeats;
+  printf("bench_tile_stats: %dx%d layer\n", width, height);
+  printf("  per-cell GetTile   %6.2f ns/cell\n", loop_ns);
+  printf("  tile_stats_build   %6.2f ns/cell%s\n", stats_ns, check ? "  MISMATCH" : "");
+
+  delete map;
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include "test_util.h"
+#include "convert.h"
+
+static int read_word(const unsigned char *data)
+{
+  return (short) ((data[0] << 8) | data[1]);
+}
+
+// Floor tile animated through frames of the given tile ids and durations
+static std::string animated_tile_text(int id, const int *frames, int num_frames)
+{
+  char text[256];
+  snprintf(text, sizeof(text), "<tile id=\"%d\"><properties><property name=\"type\" value=\"floor\"/>"
+           "<property name=\"mask\" value=\"0\"/></properties><animation>", id);
+  std::string tile = text;
+  for (int i = 0; i < num_frames; i++) {
+    snprintf(text, sizeof(text), "<frame tileid=\"%d\" duration=\"%d\"/>", frames[i * 2], frames[i * 2 + 1]);
+    tile += text;
+  }
+
+  return tile + "</animation></tile>\n";
+}
+
+// Layers l0 and l1 are flattened into plane 0, l2 stays plane 1. Tile 4 is animated in
+// l0 at (1, 0), where l1 hides it, and at (2, 2), tile 1 in l1 at (0, 1) and (3, 1),
+// tile 4 again in l2 at (3, 0) and (1, 2).
+static void check_table(bool vertical)
+{
+  // Tile 4 comes first in the tileset, the table is in tile id order
+  const int frames4[] = { 4, 50, 5, 60 };
+  const int frames1[] = { 1, 100, 2, 150, 3, 200 };
+  const std::string tiles = test_tile_text(0, "floor", 0) + animated_tile_text(4, frames4, 2) + animated_tile_text(1, frames1, 3);
+
+  std::vector< std::vector<unsigned> > gids(3);
+  const unsigned l0[] = { 1, 5, 1, 1,  1, 1, 1, 1,  1, 1, 5, 1 };
+  const unsigned l1[] = { 0, 1, 0, 0,  2, 0, 0, 2,  0, 0, 0, 0 };
+  const unsigned l2[] = { 0, 0, 0, 5,  0, 0, 0, 0,  0, 5, 0, 0 };
+  gids[0].assign(l0, l0 + 12);
+  gids[1].assign(l1, l1 + 12);
+  gids[2].assign(l2, l2 + 12);
+  Tmx::Map *map = test_parse_map(test_map_text(4, 3, 6, tiles, gids, ""));
+
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--container", "--animations", "--flatten", "l[01]", "--vertical" };
+  CHECK(convert_parse_options(&opts, vertical ? 5 : 4, args, NULL));
+
+  lev_buffer out;
+  lev_entry entry;
+  const unsigned char *data = NULL;
+  CHECK(convert_level(map, &opts, &out, NULL) == 0);
+  if (!out.data.empty()) {
+    data = lev_find_section(&out.data[0], out.data.size(), LEV_SECTION_ANIMATIONS, &entry);
+  }
+  delete map;
+
+  // Two animations of five words, five frames of two words, five cells of three words
+  const unsigned expected_size = 2 + 2 * 10 + 2 + 5 * 4 + 2 + 5 * 6;
+  CHECK(data && entry.size == expected_size);
+  if (!data || entry.size != expected_size) {
+    return;
+  }
+
+  // Tile, first frame, number of frames, first cell, number of cells
+  const int anims[2][5] = { { 1, 0, 3, 0, 2 }, { 4, 3, 2, 2, 3 } };
+  CHECK(read_word(data) == 2);
+  for (int i = 0; i < 2; i++) {
+    for (int k = 0; k < 5; k++) {
+      CHECK(read_word(data + 2 + i * 10 + k * 2) == anims[i][k]);
+    }
+  }
+
+  const int frames[5][2] = { { 1, 100 }, { 2, 150 }, { 3, 200 }, { 4, 50 }, { 5, 60 } };
+  const unsigned char *frame_data = data + 2 + 2 * 10;
+  CHECK(read_word(frame_data) == 5);
+  for (int i = 0; i < 5; i++) {
+    CHECK(read_word(frame_data + 2 + i * 4) == frames[i][0]);
+    CHECK(read_word(frame_data + 2 + i * 4 + 2) == frames[i][1]);
+  }
+
+  // Plane, x and y. Cells of an animation are sorted along the scroll axis: by column,
+  // or by row when vertical. The cell hidden by the flattened l1 is left out.
+  const int columns[5][3] = { { 0, 0, 1 }, { 0, 3, 1 }, { 1, 1, 2 }, { 0, 2, 2 }, { 1, 3, 0 } };
+  const int rows[5][3] = { { 0, 0, 1 }, { 0, 3, 1 }, { 1, 3, 0 }, { 1, 1, 2 }, { 0, 2, 2 } };
+  const unsigned char *cell_data = frame_data + 2 + 5 * 4;
+  CHECK(read_word(cell_data) == 5);
+  for (int i = 0; i < 5; i++) {
+    for (int k = 0; k < 3; k++) {
+      CHECK(read_word(cell_data + 2 + i * 6 + k * 2) == (vertical ? rows[i][k] : columns[i][k]));
+    }
+  }
+}
+
+int main()
+{
+  check_table(false);
+  check_table(true);
+
+  return test_result("test_anim_table");
+}
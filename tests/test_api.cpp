@@ -0,0 +1,52 @@
+#include <string.h>
+#include "test_util.h"
+#include "tmx2lev.h"
+
+// Convert through the C interface and check the status, and that the log holds the message
+static void check_convert(const std::string &text, int num_args, const char *const *args, bool ok, const char *message)
+{
+  tmx2lev_result *result = tmx2lev_convert(text.data(), text.size(), NULL, num_args, args);
+  CHECK(result != NULL);
+  if (!result) {
+    return;
+  }
+
+  CHECK(ok ? tmx2lev_result_status(result) == 0 : tmx2lev_result_status(result) != 0);
+  CHECK(ok ? tmx2lev_result_size(result) > 0 : tmx2lev_result_size(result) == 0);
+  CHECK(!message || strstr(tmx2lev_result_log(result), message) != NULL);
+  if (message && !strstr(tmx2lev_result_log(result), message)) {
+    printf("log lacks \"%s\":\n%s", message, tmx2lev_result_log(result));
+  }
+
+  tmx2lev_result_free(result);
+}
+
+int main()
+{
+  CHECK(tmx2lev_api_version() == TMX2LEV_API_VERSION);
+
+  std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(4 * 4, 1));
+  const std::string map = test_map_text(4, 4, 1, test_tile_text(0, "floor", 0), layers, "");
+
+  // Values are taken as values, not as options
+  const char *values[] = { "--container", "--datasize", "auto", "--collision", "16", "--areas", "areas", "--lightmap", "2" };
+  check_convert(map, sizeof(values) / sizeof(values[0]), values, true, NULL);
+
+  const char *unknown[] = { "--container", "--bogus" };
+  check_convert(map, 2, unknown, false, "error: --bogus is not an option");
+
+  const char *stray[] = { "--collision", "16", "16" };
+  check_convert(map, 3, stray, false, "error: 16 is not an option");
+
+  const char *missing[] = { "--container", "--strips" };
+  check_convert(map, 2, missing, false, "error: --strips is not an option or lacks its value");
+
+  const char *cache[] = { "--cache", "level.snap" };
+  check_convert(map, 2, cache, false, "error: --cache is not supported by the library");
+
+  // Parse errors give the error code of the parser
+  const std::string broken = "<map";
+  check_convert(broken, 0, NULL, false, "error code:");
+
+  return test_result("test_api");
+}
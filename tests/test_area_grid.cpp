@@ -0,0 +1,85 @@
+#include "test_util.h"
+#include "area_grid.h"
+
+static void random_areas(std::vector<area_rect> *areas, int count, int map_width, int map_height, unsigned *seed)
+{
+  areas->clear();
+  for (int i = 0; i < count; i++) {
+    // Some areas stick out of the map or are empty, the grid must cope with both
+    area_rect area;
+    area.x = (int) (test_rand(seed) % (map_width + 64)) - 32;
+    area.y = (int) (test_rand(seed) % (map_height + 64)) - 32;
+    area.width = test_rand(seed) % 200;
+    area.height = test_rand(seed) % 200;
+    areas->push_back(area);
+  }
+}
+
+// Every grid query must return the same areas in the same order as the linear scan
+static void check_query()
+{
+  const int map_width = 1600;
+  const int map_height = 960;
+  const int cell_sizes[] = { 16, 48, 160, 2000 };
+  unsigned seed = 7;
+
+  std::vector<area_rect> areas;
+  random_areas(&areas, 300, map_width, map_height, &seed);
+
+  for (unsigned int c = 0; c < sizeof(cell_sizes) / sizeof(cell_sizes[0]); c++) {
+    area_grid grid;
+    CHECK(area_grid_build(&grid, areas, map_width, map_height, cell_sizes[c], cell_sizes[c]));
+
+    for (int py = -20; py < map_height + 20; py += 3) {
+      for (int px = -20; px < map_width + 20; px += 5) {
+        int expected[300];
+        int found[300];
+        const int num_expected = area_list_query(areas, px, py, expected, 300);
+        const int num_found = area_grid_query(&grid, areas, px, py, found, 300);
+
+        // Points outside the map are not covered by the grid
+        if (px < 0 || py < 0 || px >= map_width || py >= map_height) {
+          continue;
+        }
+
+        CHECK(num_found == num_expected);
+        for (int i = 0; i < num_found && i < num_expected; i++) {
+          CHECK(found[i] == expected[i]);
+        }
+      }
+    }
+  }
+}
+
+// Tables that do not fit the 16-bit offsets and indices must be refused, not truncated
+static void check_overflow()
+{
+  std::vector<area_rect> areas(AREA_GRID_MAX_ENTRIES + 1);
+  for (unsigned int i = 0; i < areas.size(); i++) {
+    area_rect area = { 0, 0, 16, 16 };
+    areas[i] = area;
+  }
+
+  area_grid grid;
+  CHECK(!area_grid_build(&grid, areas, 64, 64, 16, 16));
+
+  // Few areas, but each covers every one of the 4096 cells
+  areas.resize(20);
+  for (unsigned int i = 0; i < areas.size(); i++) {
+    area_rect area = { 0, 0, 1024, 1024 };
+    areas[i] = area;
+  }
+  CHECK(!area_grid_build(&grid, areas, 1024, 1024, 16, 16));
+
+  areas.resize(15);
+  CHECK(area_grid_build(&grid, areas, 1024, 1024, 16, 16));
+  CHECK(grid.indices.size() == 15 * 4096);
+}
+
+int main()
+{
+  check_query();
+  check_overflow();
+
+  return test_result("test_area_grid");
+}
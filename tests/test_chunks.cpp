@@ -0,0 +1,81 @@
+#include "test_util.h"
+#include "convert.h"
+
+static int read_word(const unsigned char *data)
+{
+  return (short) ((data[0] << 8) | data[1]);
+}
+
+// Infinite 4x4 map: a chunked layer, an empty layer without chunks and a layer stored without chunks
+static std::string infinite_map_text()
+{
+  return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         "<map version=\"1.2\" orientation=\"orthogonal\" width=\"4\" height=\"4\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+         "<tileset firstgid=\"1\" name=\"t\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"4\">\n"
+         + test_tile_text(0, "floor", 0) + "</tileset>\n"
+         "<layer name=\"chunked\" width=\"4\" height=\"4\"><data encoding=\"csv\">\n"
+         "<chunk x=\"-4\" y=\"8\" width=\"4\" height=\"4\">2,2,2,2,2,3,3,2,2,3,3,2,0,0,0,2</chunk>\n"
+         "</data></layer>\n"
+         "<layer name=\"empty\" width=\"4\" height=\"4\"><data encoding=\"csv\"></data></layer>\n"
+         "<layer name=\"dense\" width=\"4\" height=\"4\"><data encoding=\"csv\">0,4,0,0,0,0,0,0,0,0,0,0,0,0,0,4</data></layer>\n"
+         "</map>\n";
+}
+
+// Every plane of a chunked layer section starts with a chunk count, whatever its layer holds
+static void check_planes(bool vertical)
+{
+  Tmx::Map *map = test_parse_map(infinite_map_text());
+
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--container", "--chunks", "--vertical" };
+  CHECK(convert_parse_options(&opts, vertical ? 3 : 2, args, NULL));
+
+  lev_buffer out;
+  lev_entry entry;
+  const unsigned char *data = NULL;
+  CHECK(convert_level(map, &opts, &out, NULL) == 0);
+  if (!out.data.empty()) {
+    data = lev_find_section(&out.data[0], out.data.size(), LEV_SECTION_LAYERS, &entry);
+  }
+  delete map;
+
+  // Size, then three planes: one chunk of 4x4 tiles, no chunk, one chunk of 4x4 tiles
+  const int plane_size = 2 + 8 + 16 * 2;
+  CHECK(data && entry.size == (unsigned) (4 + plane_size + 2 + plane_size));
+  CHECK(data && entry.flags == (LEV_FLAG_CHUNKED | (vertical ? LEV_FLAG_VERTICAL : 0)));
+  if (!data || entry.size != (unsigned) (4 + plane_size + 2 + plane_size)) {
+    return;
+  }
+
+  CHECK(read_word(data) == 4 && read_word(data + 2) == 4);
+
+  const int chunked[16] = { 1, 1, 1, 1, 1, 2, 2, 1, 1, 2, 2, 1, 0, 0, 0, 1 };
+  const int dense[16] = { 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3 };
+  const int offsets[2] = { 4, 4 + plane_size + 2 };
+  const int *tiles[2] = { chunked, dense };
+
+  for (int k = 0; k < 2; k++) {
+    const unsigned char *plane = data + offsets[k];
+    CHECK(read_word(plane) == 1);
+    CHECK(read_word(plane + 2) == 0 && read_word(plane + 4) == 0);
+    CHECK(read_word(plane + 6) == 4 && read_word(plane + 8) == 4);
+
+    for (int i = 0; i < 16; i++) {
+      const int x = vertical ? i / 4 : i % 4;
+      const int y = vertical ? i % 4 : i / 4;
+      CHECK(read_word(plane + 10 + i * 2) == tiles[k][y * 4 + x]);
+    }
+  }
+
+  // The empty layer is a plane without chunks
+  CHECK(read_word(data + 4 + plane_size) == 0);
+}
+
+int main()
+{
+  check_planes(false);
+  check_planes(true);
+
+  return test_result("test_chunks");
+}
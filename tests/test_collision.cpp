@@ -0,0 +1,83 @@
+#include "test_util.h"
+#include "collision.h"
+#include "convert.h"
+
+// The baked collision plane must give the same mask as the per-layer tile lookups the game does
+static void check_baked_plane()
+{
+  const int width = 37;
+  const int height = 23;
+  const int num_tiles = 8;
+  unsigned seed = 1;
+
+  std::string tiles;
+  for (int i = 0; i < num_tiles; i++) {
+    tiles += test_tile_text(i, (i & 1) ? "rock" : "floor", test_rand(&seed) & 0xffff);
+  }
+
+  // Gid 0 leaves holes, so empty cells are covered as well
+  std::vector< std::vector<unsigned> > layers(3);
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    for (int j = 0; j < width * height; j++) {
+      layers[i].push_back(test_rand(&seed) % (num_tiles + 1));
+    }
+  }
+
+  Tmx::Map *map = test_parse_map(test_map_text(width, height, num_tiles, tiles, layers, ""));
+
+  std::vector<const Tmx::Layer *> layer_list;
+  for (int i = 0; i < map->GetNumLayers(); i++) {
+    layer_list.push_back(map->GetLayer(i));
+  }
+
+  std::vector<tile_attr> attrs;
+  tile_attrs_build(&attrs, map->GetTileset(0), get_max_tiles(map->GetTileset(0)));
+
+  collision_map cmap;
+  collision_build(&cmap, layer_list, attrs);
+  CHECK(cmap.width == width && cmap.height == height);
+
+  for (int y = -1; y <= height; y++) {
+    for (int x = -1; x <= width; x++) {
+      CHECK(collision_get(&cmap, x, y) == collision_lookup(layer_list, attrs, x, y));
+    }
+  }
+
+  for (int py = 0; py < height * 16; py += 5) {
+    for (int px = 0; px < width * 16; px += 7) {
+      CHECK(collision_probe(&cmap, px, py, 16, 16) == collision_lookup(layer_list, attrs, px / 16, py / 16));
+    }
+  }
+
+  delete map;
+}
+
+// Only 1 and 16 bits per cell are valid plane sizes
+static void check_collision_option()
+{
+  const char *valid[] = { "1", "16" };
+  const char *invalid[] = { "0", "2", "8", "17", "x" };
+
+  for (unsigned int i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+    convert_options opts;
+    convert_options_init(&opts);
+    const char *args[] = { "--collision", valid[i] };
+    CHECK(convert_parse_options(&opts, 2, args, NULL));
+    CHECK(opts.collision_bits == atoi(valid[i]));
+  }
+
+  for (unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    convert_options opts;
+    convert_options_init(&opts);
+    const char *args[] = { "--collision", invalid[i] };
+    CHECK(!convert_parse_options(&opts, 2, args, NULL));
+  }
+}
+
+int main()
+{
+  check_baked_plane();
+  check_collision_option();
+
+  return test_result("test_collision");
+}
@@ -0,0 +1,209 @@
+#include <math.h>
+#include "test_util.h"
+#include "convex.h"
+#include "convert.h"
+
+static std::vector<Tmx::Point> make_polygon(const int *coords, int num_points)
+{
+  std::vector<Tmx::Point> points;
+  for (int i = 0; i < num_points; i++) {
+    Tmx::Point point = { coords[i * 2], coords[i * 2 + 1] };
+    points.push_back(point);
+  }
+
+  return points;
+}
+
+static long long cross(const Tmx::Point &a, const Tmx::Point &b, const Tmx::Point &c)
+{
+  return (long long) (b.x - a.x) * (c.y - a.y) - (long long) (b.y - a.y) * (c.x - a.x);
+}
+
+// Twice the area of a polygon, whatever its winding
+static long long twice_area(const std::vector<Tmx::Point> &points)
+{
+  long long area = 0;
+  for (unsigned int i = 0; i < points.size(); i++) {
+    const Tmx::Point &a = points[i];
+    const Tmx::Point &b = points[(i + 1) % points.size()];
+    area += (long long) a.x * b.y - (long long) b.x * a.y;
+  }
+
+  return area < 0 ? -area : area;
+}
+
+// Every piece turns the same way at each of its points, has outward unit normals in 2.14
+// perpendicular to its edges and uses only points of the polygon. Together the pieces
+// have the area of the polygon and agree with it at every sample point, so they cover it
+// without overlapping.
+static void check_pieces(const std::vector<convex_piece> &pieces, const std::vector<Tmx::Point> &polygon)
+{
+  long long area = 0;
+
+  for (unsigned int i = 0; i < pieces.size(); i++) {
+    const convex_piece &piece = pieces[i];
+    const int n = piece.points.size();
+    CHECK(n >= 3 && (int) piece.normals.size() == n);
+    if (n < 3 || (int) piece.normals.size() != n) {
+      continue;
+    }
+
+    convex_box box;
+    convex_bounds(&box, piece.points);
+    CHECK(box.x0 == piece.box.x0 && box.y0 == piece.box.y0 && box.x1 == piece.box.x1 && box.y1 == piece.box.y1);
+
+    for (int j = 0; j < n; j++) {
+      const Tmx::Point &a = piece.points[j];
+      const Tmx::Point &b = piece.points[(j + 1) % n];
+      CHECK(cross(a, b, piece.points[(j + 2) % n]) > 0);
+
+      bool in_polygon = false;
+      for (unsigned int k = 0; k < polygon.size(); k++) {
+        in_polygon = in_polygon || (polygon[k].x == a.x && polygon[k].y == a.y);
+      }
+      CHECK(in_polygon);
+
+      const Tmx::Point &normal = piece.normals[j];
+      const double length = sqrt((double) normal.x * normal.x + (double) normal.y * normal.y);
+      const double edge = sqrt((double) (b.x - a.x) * (b.x - a.x) + (double) (b.y - a.y) * (b.y - a.y));
+      CHECK(fabs(length - CONVEX_NORMAL_ONE) < 2);
+      CHECK(fabs(((double) (b.x - a.x) * normal.x + (double) (b.y - a.y) * normal.y) / edge) < 2);
+
+      for (int k = 0; k < n; k++) {
+        const Tmx::Point &p = piece.points[k];
+        CHECK((long long) (p.x - a.x) * normal.x + (long long) (p.y - a.y) * normal.y <= 0);
+      }
+    }
+
+    area += twice_area(piece.points);
+  }
+
+  CHECK(area == twice_area(polygon));
+  CHECK(convex_check(pieces, polygon, 64) == 0);
+}
+
+// Decompose a polygon, check its pieces and give their number, -1 if it is refused
+static int decompose(const int *coords, int num_points)
+{
+  const std::vector<Tmx::Point> polygon = make_polygon(coords, num_points);
+  std::vector<convex_piece> pieces;
+  if (!convex_decompose(&pieces, polygon)) {
+    CHECK(pieces.empty());
+    return -1;
+  }
+
+  check_pieces(pieces, polygon);
+  return pieces.size();
+}
+
+static void check_shapes()
+{
+  const int square[] = { 0, 0, 40, 0, 40, 40, 0, 40 };
+  const int hexagon[] = { 10, 0, 30, 0, 40, 20, 30, 40, 10, 40, 0, 20 };
+  const int l_shape[] = { 0, 0, 40, 0, 40, 20, 20, 20, 20, 40, 0, 40 };
+  const int u_shape[] = { 0, 0, 60, 0, 60, 40, 40, 40, 40, 20, 20, 20, 20, 40, 0, 40 };
+  const int l_clockwise[] = { 0, 0, 0, 40, 20, 40, 20, 20, 40, 20, 40, 0 };
+  const int u_clockwise[] = { 0, 0, 0, 40, 20, 40, 20, 20, 40, 20, 40, 40, 60, 40, 60, 0 };
+
+  CHECK(decompose(square, 4) == 1);
+  CHECK(decompose(hexagon, 6) == 1);
+  CHECK(decompose(l_shape, 6) == 2);
+  CHECK(decompose(u_shape, 8) == 3);
+  CHECK(decompose(l_clockwise, 6) == 2);
+  CHECK(decompose(u_clockwise, 8) == 3);
+
+  // Collinear and repeated points are dropped, a closing point is the first one
+  const int collinear[] = { 0, 0, 20, 0, 40, 0, 40, 0, 40, 40, 0, 40, 0, 20, 0, 0 };
+  CHECK(decompose(collinear, 8) == 1);
+  const int l_collinear[] = { 0, 0, 20, 0, 40, 0, 40, 20, 30, 20, 20, 20, 20, 40, 0, 40, 0, 30 };
+  CHECK(decompose(l_collinear, 9) == 2);
+
+  std::vector<convex_piece> pieces;
+  CHECK(convex_decompose(&pieces, make_polygon(collinear, 8)) && pieces.size() == 1 && pieces[0].points.size() == 4);
+
+  // Crossing edges, no area and too few points are refused
+  const int bow_tie[] = { 0, 0, 40, 40, 40, 0, 0, 40 };
+  const int crossed_u[] = { 0, 0, 60, 0, 60, 40, 20, 20, 40, 20, 0, 40 };
+  const int line[] = { 0, 0, 20, 10, 40, 20 };
+  const int two_points[] = { 0, 0, 40, 40 };
+  CHECK(decompose(bow_tie, 4) == -1);
+  CHECK(decompose(crossed_u, 6) == -1);
+  CHECK(decompose(line, 3) == -1);
+  CHECK(decompose(two_points, 2) == -1);
+}
+
+// Edge normals of a 3-4-5 right triangle, each edge from point i to point i + 1
+static void check_normals()
+{
+  const int triangle[] = { 0, 0, 40, 0, 40, 30 };
+  const int normals[3][2] = { { 0, -16384 }, { 16384, 0 }, { -9830, 13107 } };
+
+  std::vector<convex_piece> pieces;
+  CHECK(convex_decompose(&pieces, make_polygon(triangle, 3)) && pieces.size() == 1);
+  if (pieces.size() != 1) {
+    return;
+  }
+
+  // Given clockwise, the triangle is turned around and its normals still point out
+  const int clockwise[] = { 0, 0, 40, 30, 40, 0 };
+  std::vector<convex_piece> turned;
+  CHECK(convex_decompose(&turned, make_polygon(clockwise, 3)) && turned.size() == 1);
+
+  for (int i = 0; i < 3; i++) {
+    CHECK(pieces[0].points[i].x == triangle[i * 2] && pieces[0].points[i].y == triangle[i * 2 + 1]);
+    CHECK(pieces[0].normals[i].x == normals[i][0] && pieces[0].normals[i].y == normals[i][1]);
+
+    bool found = false;
+    for (unsigned int j = 0; j < 3 && turned.size() == 1; j++) {
+      found = found || (turned[0].normals[j].x == normals[i][0] && turned[0].normals[j].y == normals[i][1]);
+    }
+    CHECK(found);
+  }
+}
+
+static int read_word(const unsigned char *data)
+{
+  return (short) ((data[0] << 8) | data[1]);
+}
+
+// The polygon section holds the triangle of an area as pieces, moved to the area
+static void check_written()
+{
+  std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(8 * 8, 1));
+  const std::string areas = "<objectgroup name=\"areas\"><object id=\"1\" type=\"door\" x=\"16\" y=\"16\">"
+                            "<polygon points=\"0,0 40,0 40,30\"/></object></objectgroup>\n";
+  Tmx::Map *map = test_parse_map(test_map_text(8, 8, 1, test_tile_text(0, "floor", 0), layers, areas));
+
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--container", "--polygons" };
+  CHECK(convert_parse_options(&opts, 2, args, NULL));
+
+  lev_buffer out;
+  lev_entry entry;
+  const unsigned char *data = NULL;
+  CHECK(convert_level(map, &opts, &out, NULL) == 0);
+  if (!out.data.empty()) {
+    data = lev_find_section(&out.data[0], out.data.size(), LEV_SECTION_POLYGONS, &entry);
+  }
+  delete map;
+
+  // Count, then group, index, box and piece count of the polygon, then the point count,
+  // box, points and normals of its piece
+  const int expected[] = { 1, 1, 0, 16, 16, 56, 46, 1,
+                           3, 16, 16, 56, 46, 16, 16, 56, 16, 56, 46, 0, -16384, 16384, 0, -9830, 13107 };
+  const int num_words = sizeof(expected) / sizeof(expected[0]);
+  CHECK(data && entry.size == (unsigned) num_words * 2);
+  for (int i = 0; data && entry.size == (unsigned) num_words * 2 && i < num_words; i++) {
+    CHECK(read_word(data + i * 2) == expected[i]);
+  }
+}
+
+int main()
+{
+  check_shapes();
+  check_normals();
+  check_written();
+
+  return test_result("test_convex");
+}
@@ -0,0 +1,209 @@
+#include "test_util.h"
+#include "crop.h"
+#include "convert.h"
+
+// Flags of the layer section of a map converted to a container, -1 if the conversion fails
+static int layer_flags(const std::string &text, int num_args, const char **args)
+{
+  Tmx::Map *map = test_parse_map(text);
+
+  convert_options opts;
+  convert_options_init(&opts);
+  if (!convert_parse_options(&opts, num_args, args, NULL)) {
+    delete map;
+    return -1;
+  }
+
+  lev_buffer out;
+  int flags = -1;
+  if (convert_level(map, &opts, &out, NULL) == 0) {
+    lev_entry entry;
+    if (lev_find_section(&out.data[0], out.data.size(), LEV_SECTION_LAYERS, &entry)) {
+      flags = entry.flags;
+    }
+  }
+
+  delete map;
+  return flags;
+}
+
+// Infinite map with one layer of two chunks, the second one partly empty
+static std::string infinite_map_text()
+{
+  std::string map = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                    "<map version=\"1.2\" orientation=\"orthogonal\" width=\"8\" height=\"4\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+                    "<tileset firstgid=\"1\" name=\"t\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"2\">\n"
+                    + test_tile_text(0, "floor", 0) + "</tileset>\n"
+                    "<layer name=\"l0\" width=\"8\" height=\"4\"><data encoding=\"csv\">\n"
+                    "<chunk x=\"-4\" y=\"0\" width=\"4\" height=\"4\">1,1,1,1,1,2,2,1,1,2,2,1,1,1,1,1</chunk>\n"
+                    "<chunk x=\"0\" y=\"0\" width=\"4\" height=\"4\">0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0</chunk>\n"
+                    "</data></layer>\n</map>\n";
+  return map;
+}
+
+// Layer with empty borders, an empty row and rows of different spans, '.' for empty cells
+static const int drawn_width = 10;
+static const int drawn_height = 7;
+static const char *drawn[drawn_height] = {
+  "..........",
+  "....1.....",
+  "...22.....",
+  "..........",
+  ".....313..",
+  "......4...",
+  "..........",
+};
+
+static std::string drawn_map_text()
+{
+  std::vector< std::vector<unsigned> > layers(1);
+  for (int y = 0; y < drawn_height; y++) {
+    for (int x = 0; x < drawn_width; x++) {
+      layers[0].push_back(drawn[y][x] == '.' ? 0 : drawn[y][x] - '0');
+    }
+  }
+
+  return test_map_text(drawn_width, drawn_height, 4, test_tile_text(0, "floor", 0), layers, "");
+}
+
+static void check_bounds()
+{
+  Tmx::Map *map = test_parse_map(drawn_map_text());
+  std::vector<const Tmx::Layer *> layers(1, map->GetLayer(0));
+  plane p;
+  p.layers.push_back(0);
+
+  crop_box box;
+  crop_bounds(&box, &p, layers, drawn_width, drawn_height);
+  CHECK(box.x == 3 && box.y == 1 && box.width == 5 && box.height == 5);
+
+  // Spans of the rows, and of the columns when vertical, relative to the box
+  const crop_span rows[5] = { { 1, 1 }, { 0, 2 }, { 0, 0 }, { 2, 3 }, { 3, 1 } };
+  const crop_span cols[5] = { { 1, 1 }, { 0, 2 }, { 3, 1 }, { 3, 2 }, { 3, 1 } };
+  for (int v = 0; v < 2; v++) {
+    std::vector<crop_span> spans;
+    crop_spans(&spans, &box, &p, layers, drawn_width, v == 1);
+    CHECK(spans.size() == 5);
+    for (unsigned int i = 0; i < spans.size() && i < 5; i++) {
+      const crop_span &expected = v ? cols[i] : rows[i];
+      CHECK(spans[i].first == expected.first && spans[i].count == expected.count);
+    }
+  }
+
+  // Bytes of the plane as written: the whole layer, the box, the box and span table
+  CHECK(crop_plane_bytes(&p, layers, drawn_width, drawn_height, 2, false, false, false) == 10 * 7 * 2);
+  CHECK(crop_plane_bytes(&p, layers, drawn_width, drawn_height, 2, true, false, false) == 8 + 5 * 5 * 2);
+  CHECK(crop_plane_bytes(&p, layers, drawn_width, drawn_height, 1, true, true, false) == 8 + 5 * 4 + 7);
+  CHECK(crop_plane_bytes(&p, layers, drawn_width, drawn_height, 1, true, true, true) == 8 + 5 * 4 + 7);
+
+  delete map;
+
+  // An empty plane has an empty box and no spans
+  std::vector< std::vector<unsigned> > empty(1, std::vector<unsigned>(12, 0));
+  map = test_parse_map(test_map_text(4, 3, 1, test_tile_text(0, "floor", 0), empty, ""));
+  layers[0] = map->GetLayer(0);
+  crop_bounds(&box, &p, layers, 4, 3);
+  CHECK(box.x == 0 && box.y == 0 && box.width == 0 && box.height == 0);
+  CHECK(crop_plane_bytes(&p, layers, 4, 3, 2, true, true, false) == 8);
+  delete map;
+}
+
+static int read_word(const unsigned char *data)
+{
+  return (short) ((data[0] << 8) | data[1]);
+}
+
+// Read the cropped plane back from the layer section and compare every cell with the drawing
+static void check_written(bool spans, bool vertical)
+{
+  Tmx::Map *map = test_parse_map(drawn_map_text());
+
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--container", spans ? "--spans" : "--crop", "--vertical" };
+  CHECK(convert_parse_options(&opts, vertical ? 3 : 2, args, NULL));
+
+  lev_buffer out;
+  lev_entry entry;
+  const unsigned char *data = NULL;
+  CHECK(convert_level(map, &opts, &out, NULL) == 0);
+  if (!out.data.empty()) {
+    data = lev_find_section(&out.data[0], out.data.size(), LEV_SECTION_LAYERS, &entry);
+  }
+  delete map;
+
+  // Map size, box, span table of the five rows or columns and the words of the tiles
+  const unsigned expected_size = spans ? 4 + 8 + 5 * 4 + 7 * 2 : 4 + 8 + 5 * 5 * 2;
+  CHECK(data && entry.size == expected_size);
+  if (!data || entry.size != expected_size) {
+    return;
+  }
+
+  CHECK(read_word(data) == drawn_width && read_word(data + 2) == drawn_height);
+  const int box_x = read_word(data + 4);
+  const int box_y = read_word(data + 6);
+  const int box_width = read_word(data + 8);
+  const int box_height = read_word(data + 10);
+  CHECK(box_x == 3 && box_y == 1 && box_width == 5 && box_height == 5);
+  if (box_width != 5 || box_height != 5) {
+    return;
+  }
+
+  std::vector<int> cells(drawn_width * drawn_height, -1);
+  const unsigned char *spans_data = data + 12;
+  const unsigned char *tile = spans ? spans_data + 5 * 4 : spans_data;
+  for (int o = 0; o < 5; o++) {
+    const int first = spans ? read_word(spans_data + o * 4) : 0;
+    const int count = spans ? read_word(spans_data + o * 4 + 2) : 5;
+    for (int n = first; n < first + count; n++, tile += 2) {
+      const int x = box_x + (vertical ? o : n);
+      const int y = box_y + (vertical ? n : o);
+      cells[y * drawn_width + x] = read_word(tile);
+    }
+  }
+  CHECK(tile == data + entry.size);
+
+  // Cells left out must be empty, the others hold their tile id or 0 when empty
+  for (int y = 0; y < drawn_height; y++) {
+    for (int x = 0; x < drawn_width; x++) {
+      const int id = drawn[y][x] == '.' ? -1 : drawn[y][x] - '1';
+      const int cell = cells[y * drawn_width + x];
+      CHECK(cell == id || (id < 0 && cell == 0 && !spans));
+    }
+  }
+}
+
+int main()
+{
+  check_bounds();
+  for (int v = 0; v < 2; v++) {
+    check_written(false, v == 1);
+    check_written(true, v == 1);
+  }
+
+  std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(64, 0));
+  for (int y = 2; y < 5; y++) {
+    for (int x = 3; x < 6; x++) {
+      layers[0][y * 8 + x] = 1;
+    }
+  }
+  const std::string finite = test_map_text(8, 8, 1, test_tile_text(0, "floor", 0), layers, "");
+  const std::string infinite = infinite_map_text();
+
+  // Dense layers carry the box and the span table that the flags announce
+  const char *crop_args[] = { "--container", "--crop" };
+  const char *span_args[] = { "--container", "--spans" };
+  CHECK(layer_flags(finite, 2, crop_args) == LEV_FLAG_CROPPED);
+  CHECK(layer_flags(finite, 2, span_args) == (LEV_FLAG_CROPPED | LEV_FLAG_SPANS));
+
+  // Chunks have their own bounds, neither flag may be set next to the chunk flag
+  const char *chunk_crop_args[] = { "--container", "--chunks", "--crop" };
+  const char *chunk_span_args[] = { "--container", "--chunks", "--spans" };
+  CHECK(layer_flags(infinite, 3, chunk_crop_args) == LEV_FLAG_CHUNKED);
+  CHECK(layer_flags(infinite, 3, chunk_span_args) == LEV_FLAG_CHUNKED);
+
+  // Without chunks an infinite map is flattened to a dense layer, which is cropped
+  CHECK(layer_flags(infinite, 2, span_args) == (LEV_FLAG_CROPPED | LEV_FLAG_SPANS));
+
+  return test_result("test_crop");
+}
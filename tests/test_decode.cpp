@@ -0,0 +1,139 @@
+#include <string.h>
+#include <zlib.h>
+#include "test_util.h"
+#include "TmxUtil.h"
+#include "base64.h"
+
+// Rows and columns are primes, so no task count divides them
+static const int width = 503;
+static const int height = 331;
+
+static std::string layer_map_text(const std::string &data_attrs, const std::string &data)
+{
+  char text[512];
+  snprintf(text, sizeof(text), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"16\" tileheight=\"16\">\n"
+           "<tileset firstgid=\"1\" name=\"a\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"100\"/>\n"
+           "<tileset firstgid=\"101\" name=\"b\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"5000\"/>\n"
+           "<layer name=\"l\" width=\"%d\" height=\"%d\"><data %s>", width, height, width, height, data_attrs.c_str());
+  return text + data + "</data></layer>\n</map>\n";
+}
+
+// Gids as Tiled writes them in csv, one row per line with a trailing comma
+static std::string csv_text(const std::vector<unsigned> &gids)
+{
+  std::string text = "\n";
+  char number[16];
+  for (unsigned int i = 0; i < gids.size(); i++) {
+    snprintf(number, sizeof(number), "%u", gids[i]);
+    text += number;
+    if (i + 1 < gids.size()) {
+      text += (i + 1) % width ? "," : ",\n";
+    }
+  }
+
+  return text + "\n";
+}
+
+static std::string base64_text(const std::vector<unsigned> &gids, int compression)
+{
+  const unsigned char *bytes = (const unsigned char *) &gids[0];
+  const unsigned long size = gids.size() * 4;
+  if (compression == 0) {
+    return base64_encode(bytes, size);
+  }
+
+  // windowBits 15 writes a zlib stream, 31 a gzip one
+  std::vector<unsigned char> packed(compressBound(size) + 32);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, compression == 1 ? 15 : 31, 8, Z_DEFAULT_STRATEGY);
+  stream.next_in = (unsigned char *) bytes;
+  stream.avail_in = size;
+  stream.next_out = &packed[0];
+  stream.avail_out = packed.size();
+  deflate(&stream, Z_FINISH);
+  const unsigned int packed_size = stream.total_out;
+  deflateEnd(&stream);
+
+  return base64_encode(&packed[0], packed_size);
+}
+
+// Parse and decode a layer with the work split for num_threads threads
+static Tmx::Map* decode_map(const std::string &text, int num_threads)
+{
+  Tmx::Util::SetNumThreads(num_threads);
+  Tmx::Map *map = test_parse_map(text);
+  map->GetLayer(0)->Decode();
+  Tmx::Util::SetNumThreads(0);
+
+  return map;
+}
+
+static void check_encoding(const char *name, const std::string &text, const std::vector<unsigned> &gids)
+{
+  const int thread_counts[] = { 2, 3, 7, 16 };
+  Tmx::Map *serial = decode_map(text, 1);
+  const Tmx::Layer *expected = serial->GetLayer(0);
+
+  // The serial decode must give the gids the text was made from
+  int mismatches = 0;
+  for (int i = 0; i < width * height; i++) {
+    const unsigned clean = gids[i] & 0x1fffffff;
+    const int tileset = clean == 0 ? -1 : clean >= 101 ? 1 : 0;
+    const Tmx::MapTile tile(gids[i], tileset == 1 ? 101 : tileset == 0 ? 1 : 0, tileset);
+    const Tmx::MapTile &decoded = expected->GetTile(i % width, i / width);
+    if (decoded.tilesetId != tile.tilesetId || decoded.id != tile.id || decoded.flippedHorizontally != tile.flippedHorizontally ||
+        decoded.flippedVertically != tile.flippedVertically || decoded.flippedDiagonally != tile.flippedDiagonally) {
+      mismatches++;
+    }
+  }
+  if (mismatches) {
+    printf("%s: serial decode differs from the source gids in %d cell(s)\n", name, mismatches);
+  }
+  CHECK(mismatches == 0);
+
+  for (unsigned int t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+    Tmx::Map *parallel = decode_map(text, thread_counts[t]);
+    const Tmx::Layer *layer = parallel->GetLayer(0);
+
+    mismatches = 0;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        const Tmx::MapTile &a = layer->GetTile(x, y);
+        const Tmx::MapTile &b = expected->GetTile(x, y);
+        if (a.tilesetId != b.tilesetId || a.id != b.id || a.flippedHorizontally != b.flippedHorizontally ||
+            a.flippedVertically != b.flippedVertically || a.flippedDiagonally != b.flippedDiagonally) {
+          mismatches++;
+        }
+      }
+    }
+    if (mismatches) {
+      printf("%s: %d thread(s) differ from the serial decode in %d cell(s)\n", name, thread_counts[t], mismatches);
+    }
+    CHECK(mismatches == 0);
+
+    delete parallel;
+  }
+
+  delete serial;
+}
+
+int main()
+{
+  unsigned seed = 29;
+  std::vector<unsigned> gids(width * height);
+  for (int i = 0; i < width * height; i++) {
+    // Numbers of every length, so task boundaries fall inside tokens of all sizes
+    const unsigned ranges[] = { 1, 10, 100, 5100 };
+    gids[i] = (test_rand(&seed) % 5) ? test_rand(&seed) % ranges[test_rand(&seed) % 4] : 0;
+    gids[i] |= (test_rand(&seed) & 7) << 29;
+  }
+
+  check_encoding("csv", layer_map_text("encoding=\"csv\"", csv_text(gids)), gids);
+  check_encoding("base64", layer_map_text("encoding=\"base64\"", base64_text(gids, 0)), gids);
+  check_encoding("zlib", layer_map_text("encoding=\"base64\" compression=\"zlib\"", base64_text(gids, 1)), gids);
+  check_encoding("gzip", layer_map_text("encoding=\"base64\" compression=\"gzip\"", base64_text(gids, 2)), gids);
+
+  return test_result("test_decode");
+}
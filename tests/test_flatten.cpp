@@ -0,0 +1,116 @@
+#include <string.h>
+#include "test_util.h"
+#include "flatten.h"
+#include "convert.h"
+
+// Tiles: 0 and 1 plain floor, 2 rock, 3 without a type, 4 an overlay drawn over tile 0,
+// 5 floor with a collision mask
+static std::string tiles_text()
+{
+  return test_tile_text(0, "floor", 0) + test_tile_text(1, "floor", 0) + test_tile_text(2, "rock", 0xffff) +
+         "<tile id=\"4\"><properties><property name=\"type\" value=\"overlay\"/><property name=\"bg_tile\" value=\"0\"/>"
+         "</properties></tile>\n" + test_tile_text(5, "floor", 0x00f0);
+}
+
+// Flatten a one cell map of two layers, gid 0 being empty, and get the number of planes
+static int flatten_cell(unsigned lower, unsigned upper, int *tile)
+{
+  std::vector< std::vector<unsigned> > gids(2);
+  gids[0].push_back(lower);
+  gids[1].push_back(upper);
+  Tmx::Map *map = test_parse_map(test_map_text(1, 1, 6, tiles_text(), gids, ""));
+
+  std::vector<const Tmx::Layer *> layers;
+  layers.push_back(map->GetLayer(0));
+  layers.push_back(map->GetLayer(1));
+  std::vector<tile_attr> attrs;
+  tile_attrs_build(&attrs, map->GetTileset(0), 6);
+
+  std::vector<plane> planes;
+  flatten_layers(&planes, layers, std::vector<bool>(2, true), attrs, 1, 1);
+  *tile = planes.size() == 1 && !plane_tile_empty(&planes[0], layers, 1, 0, 0) ? (int) plane_tile_id(&planes[0], layers, 1, 0, 0) : -1;
+
+  delete map;
+  return planes.size();
+}
+
+static void check_cells()
+{
+  // Lower gid, upper gid, whether they merge and the merged tile id
+  const struct { unsigned lower; unsigned upper; bool merge; int tile; } cells[] = {
+    { 0, 0, true, -1 },
+    { 3, 0, true, 2 },
+    { 0, 4, true, 3 },
+    { 1, 2, true, 1 },   // floor over floor of the same mask
+    { 1, 5, true, 4 },   // overlay over its bg_tile
+    { 1, 3, false, 0 },  // rock hides a floor tile of another type
+    { 6, 2, false, 0 },  // floor hides a floor tile of another mask
+    { 2, 6, false, 0 },
+    { 1, 4, false, 0 },  // no type, may be transparent
+    { 2, 5, false, 0 },  // overlay over another tile than its bg_tile
+    { 3, 3, true, 2 },
+  };
+
+  for (unsigned int i = 0; i < sizeof(cells) / sizeof(cells[0]); i++) {
+    int tile = 0;
+    const int num_planes = flatten_cell(cells[i].lower, cells[i].upper, &tile);
+    CHECK(num_planes == (cells[i].merge ? 1 : 2));
+    if (cells[i].merge) {
+      CHECK(tile == cells[i].tile);
+    }
+    if (num_planes != (cells[i].merge ? 1 : 2)) {
+      printf("cell %u: gid %u under gid %u gives %d plane(s)\n", i, cells[i].lower, cells[i].upper, num_planes);
+    }
+  }
+}
+
+static void append_log(const char *text, void *user)
+{
+  ((std::string *) user)->append(text);
+}
+
+// Bytes reported eliminated by flattening an 8x8 map whose two layers only hold a few cells
+static int saved_bytes(const char *option)
+{
+  std::vector< std::vector<unsigned> > gids(2, std::vector<unsigned>(64, 0));
+  gids[0][2 * 8 + 2] = gids[0][2 * 8 + 3] = gids[0][3 * 8 + 2] = gids[0][3 * 8 + 3] = 1;
+  gids[1][2 * 8 + 2] = 2;
+  Tmx::Map *map = test_parse_map(test_map_text(8, 8, 6, tiles_text(), gids, ""));
+
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--flatten", "*", option };
+  CHECK(convert_parse_options(&opts, option ? 3 : 2, args, NULL));
+
+  std::string text;
+  convert_log log = { append_log, &text };
+  lev_buffer out;
+  CHECK(convert_level(map, &opts, &out, &log) == 0);
+  delete map;
+
+  const char *line = strstr(text.c_str(), "Flattened ");
+  int num_layers = 0;
+  int num_planes = 0;
+  int eliminated = 0;
+  int saved = -1;
+  if (!line || sscanf(line, "Flattened %d layer(s) into %d plane(s), %d plane(s) and %d byte(s) eliminated",
+                      &num_layers, &num_planes, &eliminated, &saved) != 4) {
+    return -1;
+  }
+
+  CHECK(num_layers == 2 && num_planes == 1 && eliminated == 1);
+  return saved;
+}
+
+int main()
+{
+  check_cells();
+
+  // Whole layers: 64 words. Cropped: box and 1 word of the upper layer.
+  // With spans: box, two span words and 1 word of the upper layer.
+  CHECK(saved_bytes(NULL) == 64 * 2);
+  CHECK(saved_bytes("--crop") == 8 + 2);
+  CHECK(saved_bytes("--spans") == 8 + 4 + 2);
+
+  return test_result("test_flatten");
+}
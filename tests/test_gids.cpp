@@ -0,0 +1,106 @@
+#include <string.h>
+#include "test_util.h"
+#include "TmxUtil.h"
+
+#if defined(__AVX2__)
+#define GIDS_PATH "AVX2"
+#elif defined(__SSE2__)
+#define GIDS_PATH "SSE2"
+#else
+#define GIDS_PATH "scalar"
+#endif
+
+static bool same_tile(const Tmx::MapTile &a, const Tmx::MapTile &b)
+{
+  return a.tilesetId == b.tilesetId && a.id == b.id &&
+         a.flippedHorizontally == b.flippedHorizontally &&
+         a.flippedVertically == b.flippedVertically &&
+         a.flippedDiagonally == b.flippedDiagonally;
+}
+
+// Gids around every tileset boundary, with every combination of flip bits
+static void boundary_gids(std::vector<unsigned> *gids, const std::vector<int> &first_gids, unsigned *seed)
+{
+  const unsigned flips[] = { 0, Tmx::FlippedHorizontallyFlag, Tmx::FlippedVerticallyFlag, Tmx::FlippedDiagonallyFlag,
+                             Tmx::FlippedHorizontallyFlag | Tmx::FlippedVerticallyFlag | Tmx::FlippedDiagonallyFlag };
+
+  gids->clear();
+  for (unsigned int t = 0; t < first_gids.size(); t++) {
+    for (int d = -1; d <= 1; d++) {
+      for (unsigned int f = 0; f < sizeof(flips) / sizeof(flips[0]); f++) {
+        gids->push_back((unsigned) (first_gids[t] + d) | flips[f]);
+      }
+    }
+  }
+
+  gids->push_back(0);
+  gids->push_back(Tmx::FlippedHorizontallyFlag);
+  gids->push_back(0x1fffffff);
+  gids->push_back(0xffffffff);
+
+  for (int i = 0; i < 1000; i++) {
+    const unsigned gid = test_rand(seed) % (first_gids.back() + 50);
+    gids->push_back(gid | flips[test_rand(seed) % 5]);
+  }
+}
+
+// The vector path must give the same tiles as the scalar one for every length, so tails are covered
+static void check_paths(const std::vector<int> &first_gids, unsigned *seed)
+{
+  std::vector<unsigned> gids;
+  boundary_gids(&gids, first_gids, seed);
+
+  for (int offset = 0; offset < 9; offset++) {
+    for (int count = 0; offset + count <= (int) gids.size(); count += (count < 40 ? 1 : 97)) {
+      std::vector<Tmx::MapTile> simd(count + 1);
+      std::vector<Tmx::MapTile> scalar(count + 1);
+      Tmx::Util::ConvertGids(&gids[offset], count, first_gids, &simd[0]);
+      Tmx::Util::ConvertGidsScalar(&gids[offset], count, first_gids, &scalar[0]);
+
+      for (int i = 0; i < count; i++) {
+        CHECK(same_tile(simd[i], scalar[i]));
+      }
+
+      // Nothing past the end is written
+      CHECK(same_tile(simd[count], Tmx::MapTile()));
+    }
+  }
+
+  // The scalar reference itself must agree with the per-gid MapTile constructor
+  std::vector<Tmx::MapTile> scalar(gids.size());
+  Tmx::Util::ConvertGidsScalar(&gids[0], gids.size(), first_gids, &scalar[0]);
+  for (unsigned int i = 0; i < gids.size(); i++) {
+    const unsigned clean = gids[i] & 0x1fffffff;
+    int index = -1;
+    int first = 0;
+    for (unsigned int t = 0; t < first_gids.size(); t++) {
+      if ((int) clean >= first_gids[t]) {
+        index = t;
+        first = first_gids[t];
+      }
+    }
+
+    CHECK(same_tile(scalar[i], Tmx::MapTile(gids[i], first, index)));
+  }
+}
+
+int main()
+{
+#if defined(__AVX2__)
+  if (!__builtin_cpu_supports("avx2")) {
+    printf("test_gids (AVX2): skipped, not supported by this CPU\n");
+    return 0;
+  }
+#endif
+
+  unsigned seed = 13;
+  const int sets[][4] = { { 1, 0, 0, 0 }, { 1, 65, 0, 0 }, { 1, 2, 3, 4 }, { 1, 257, 1000, 70000 } };
+  const int sizes[] = { 1, 2, 4, 4 };
+
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    std::vector<int> first_gids(sets[s], sets[s] + sizes[s]);
+    check_paths(first_gids, &seed);
+  }
+
+  return test_result("test_gids (" GIDS_PATH ")");
+}
@@ -0,0 +1,112 @@
+#include "test_util.h"
+#include "lightmap.h"
+#include "convert.h"
+
+// Map with rock tiles scattered over a floor, tile 1 is floor and tile 2 is rock
+static Tmx::Map* rock_map(int width, int height, int rock_percent, unsigned *seed)
+{
+  std::vector< std::vector<unsigned> > layers(1);
+  for (int i = 0; i < width * height; i++) {
+    layers[0].push_back((int) (test_rand(seed) % 100) < rock_percent ? 2 : 1);
+  }
+
+  const std::string tiles = test_tile_text(0, "floor", 0) + test_tile_text(1, "rock", 0xffff);
+  return test_parse_map(test_map_text(width, height, 2, tiles, layers, ""));
+}
+
+static void build(lightmap *lmap, const Tmx::Map *map, const std::vector<light_source> &lights, int subdiv, int num_threads)
+{
+  std::vector<const Tmx::Layer *> layers(1, map->GetLayer(0));
+  std::vector<tile_attr> attrs;
+  tile_attrs_build(&attrs, map->GetTileset(0), get_max_tiles(map->GetTileset(0)));
+
+  Tmx::Util::SetNumThreads(num_threads);
+  lightmap_build(lmap, lights, layers, attrs, 16, 16, subdiv, 20);
+  Tmx::Util::SetNumThreads(0);
+}
+
+// A light fades from its center and does not pass through a rock wall
+static void check_wall()
+{
+  std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(8 * 8, 1));
+  for (int y = 0; y < 8; y++) {
+    layers[0][y * 8 + 4] = 2;
+  }
+  const std::string tiles = test_tile_text(0, "floor", 0) + test_tile_text(1, "rock", 0xffff);
+  Tmx::Map *map = test_parse_map(test_map_text(8, 8, 2, tiles, layers, ""));
+
+  std::vector<light_source> lights;
+  light_source light = { 2 * 16 + 8, 4 * 16 + 8, 3 };
+  lights.push_back(light);
+
+  lightmap lmap;
+  build(&lmap, map, lights, 2, 1);
+  CHECK(lmap.width == 16 && lmap.height == 16 && lmap.subdiv == 2);
+  CHECK(lightmap_get(&lmap, 5, 9) > lightmap_get(&lmap, 3, 9));
+  CHECK(lightmap_get(&lmap, 3, 9) > 20);
+  CHECK(lightmap_get(&lmap, 11, 9) == 20);
+  CHECK(lightmap_get(&lmap, -1, 0) == 0 && lightmap_get(&lmap, 16, 0) == 0);
+
+  delete map;
+}
+
+// Lighting bands of rows in parallel must give the cells of the serial bake
+static void check_parallel()
+{
+  unsigned seed = 41;
+  const int width = 61;
+  const int height = 47;
+  const int thread_counts[] = { 2, 3, 7, 16 };
+  Tmx::Map *map = rock_map(width, height, 10, &seed);
+
+  // Lights partly outside the map reach across the edges of the bands
+  std::vector<light_source> lights;
+  for (int i = 0; i < 300; i++) {
+    light_source light = { (int) (test_rand(&seed) % ((width + 8) * 16)) - 64, (int) (test_rand(&seed) % ((height + 8) * 16)) - 64,
+                           (int) (test_rand(&seed) % 9) };
+    lights.push_back(light);
+  }
+
+  lightmap serial;
+  build(&serial, map, lights, 3, 1);
+
+  for (unsigned int t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+    lightmap parallel;
+    build(&parallel, map, lights, 3, thread_counts[t]);
+    CHECK(parallel.width == serial.width && parallel.height == serial.height);
+    CHECK(parallel.cells == serial.cells);
+  }
+
+  delete map;
+}
+
+// The number of cells per tile is 1 to 8, other values are reported
+static void check_lightmap_option()
+{
+  const char *valid[] = { "1", "4", "8" };
+  const char *invalid[] = { "0", "9", "-1", "x" };
+
+  for (unsigned int i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+    convert_options opts;
+    convert_options_init(&opts);
+    const char *args[] = { "--lightmap", valid[i] };
+    CHECK(convert_parse_options(&opts, 2, args, NULL));
+    CHECK(opts.light_subdiv == atoi(valid[i]));
+  }
+
+  for (unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    convert_options opts;
+    convert_options_init(&opts);
+    const char *args[] = { "--lightmap", invalid[i] };
+    CHECK(!convert_parse_options(&opts, 2, args, NULL));
+  }
+}
+
+int main()
+{
+  check_wall();
+  check_parallel();
+  check_lightmap_option();
+
+  return test_result("test_lightmap");
+}
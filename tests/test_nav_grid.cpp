@@ -0,0 +1,176 @@
+#include <limits.h>
+#include <string.h>
+#include "test_util.h"
+#include "nav_grid.h"
+#include "convert.h"
+
+// Grid drawn as text, '#' for blocked cells
+static void make_grid(nav_grid *grid, const char **rows, int height)
+{
+  grid->width = strlen(rows[0]);
+  grid->height = height;
+  grid->walkable.clear();
+  grid->fields.clear();
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < grid->width; x++) {
+      grid->walkable.push_back(rows[y][x] != '#');
+    }
+  }
+}
+
+// Cost of the shortest path from every cell to the target by repeated relaxation,
+// with the same steps and costs as the flow fields
+static std::vector<int> path_costs(const nav_grid *grid, const nav_target &target)
+{
+  static const int dx[NAV_NUM_DIRECTIONS] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+  static const int dy[NAV_NUM_DIRECTIONS] = { -1, 0, 1, 0, -1, 1, -1, 1 };
+  std::vector<int> cost(grid->width * grid->height, INT_MAX);
+
+  for (int y = target.y; y < target.y + target.height; y++) {
+    for (int x = target.x; x < target.x + target.width; x++) {
+      if (nav_walkable(grid, x, y)) {
+        cost[y * grid->width + x] = 0;
+      }
+    }
+  }
+
+  for (bool changed = true; changed; ) {
+    changed = false;
+    for (int y = 0; y < grid->height; y++) {
+      for (int x = 0; x < grid->width; x++) {
+        if (!nav_walkable(grid, x, y)) {
+          continue;
+        }
+        for (int d = 0; d < NAV_NUM_DIRECTIONS; d++) {
+          const int nx = x + dx[d];
+          const int ny = y + dy[d];
+          const bool diagonal = dx[d] && dy[d];
+          if (!nav_walkable(grid, nx, ny) || (diagonal && (!nav_walkable(grid, nx, y) || !nav_walkable(grid, x, ny)))) {
+            continue;
+          }
+          const int next = cost[ny * grid->width + nx];
+          if (next != INT_MAX && next + (diagonal ? 3 : 2) < cost[y * grid->width + x]) {
+            cost[y * grid->width + x] = next + (diagonal ? 3 : 2);
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+
+  return cost;
+}
+
+// Following the field from any cell must reach the target along a shortest path
+static void check_fields()
+{
+  static const int dx[NAV_NUM_DIRECTIONS] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+  static const int dy[NAV_NUM_DIRECTIONS] = { -1, 0, 1, 0, -1, 1, -1, 1 };
+  const char *rows[] = {
+    "........#...",
+    ".####...#.#.",
+    ".#..#.....#.",
+    ".#..####.##.",
+    "...........#",
+    "##.#.###..#.",
+    "...#...#..#.",
+  };
+  const int height = sizeof(rows) / sizeof(rows[0]);
+
+  nav_grid grid;
+  make_grid(&grid, rows, height);
+
+  std::vector<nav_target> targets;
+  nav_target tube = { NAV_TARGET_SAVETUBE, 0, 2, 2, 1, 1 };
+  nav_target door = { NAV_TARGET_DOOR, 1, 9, 0, 3, 1 };
+  nav_target walled = { NAV_TARGET_SAVETUBE, 2, 11, 5, 1, 1 };
+  targets.push_back(tube);
+  targets.push_back(door);
+  targets.push_back(walled);
+  nav_flow_fields(&grid, targets);
+  CHECK(grid.fields.size() == targets.size());
+
+  for (unsigned int f = 0; f < targets.size(); f++) {
+    const std::vector<int> cost = path_costs(&grid, targets[f]);
+
+    for (int y = 0; y < grid.height; y++) {
+      for (int x = 0; x < grid.width; x++) {
+        const int dir = nav_direction(&grid, f, x, y);
+        const int here = cost[y * grid.width + x];
+        if (here == 0 || here == INT_MAX) {
+          CHECK(dir == NAV_NO_DIRECTION);
+          continue;
+        }
+
+        // One step along the field costs exactly what it saves
+        CHECK(dir >= 0 && dir < NAV_NUM_DIRECTIONS);
+        if (dir >= 0 && dir < NAV_NUM_DIRECTIONS) {
+          const int nx = x + dx[dir];
+          const int ny = y + dy[dir];
+          const bool diagonal = dx[dir] && dy[dir];
+          CHECK(nav_walkable(&grid, nx, ny));
+          CHECK(!diagonal || (nav_walkable(&grid, nx, y) && nav_walkable(&grid, x, ny)));
+          CHECK(cost[ny * grid.width + nx] + (diagonal ? 3 : 2) == here);
+        }
+      }
+    }
+  }
+
+  // Hand-checked steps: the room is left through its gap, corners are not cut
+  CHECK(nav_direction(&grid, 0, 3, 3) == 4);
+  CHECK(nav_direction(&grid, 0, 2, 4) == 0);
+  CHECK(nav_direction(&grid, 0, 0, 5) == NAV_NO_DIRECTION);
+  CHECK(nav_direction(&grid, 1, 9, 2) == 0);
+  CHECK(nav_direction(&grid, 2, 0, 0) == NAV_NO_DIRECTION);
+}
+
+// Size of the navigation section of an open 8x8 map converted with an option, negated when the
+// section lacks the flow field flag and -1 on failure. The section data is left in out.
+static int nav_section_size(const std::string &objects, const char *option, const unsigned char **data, lev_buffer *out)
+{
+  std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(8 * 8, 1));
+  Tmx::Map *map = test_parse_map(test_map_text(8, 8, 1, test_tile_text(0, "floor", 0), layers, objects));
+
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--container", option };
+  CHECK(convert_parse_options(&opts, 2, args, NULL));
+
+  int size = -1;
+  lev_entry entry;
+  out->data.clear();
+  if (convert_level(map, &opts, out, NULL) == 0 && (*data = lev_find_section(&out->data[0], out->data.size(), LEV_SECTION_NAVIGATION, &entry))) {
+    size = entry.flags & LEV_FLAG_FLOW_FIELDS ? (int) entry.size : -(int) entry.size;
+  }
+
+  delete map;
+  return size;
+}
+
+// With the flag set the target count is always written, also when there are no targets
+static void check_section()
+{
+  // Square map, so the sizes are the same stored by rows or by columns.
+  // Width and height words, then a byte of walkable bits per row.
+  const int grid_size = 4 + 8;
+  const std::string tube = "<objectgroup name=\"objects\"><object id=\"1\" type=\"savetube\" x=\"40\" y=\"40\"/></objectgroup>\n";
+  const unsigned char *data = NULL;
+  lev_buffer out;
+
+  CHECK(nav_section_size("", "--nav", &data, &out) == -grid_size);
+
+  CHECK(nav_section_size("", "--flow-fields", &data, &out) == grid_size + 2);
+  CHECK(data && data[grid_size] == 0 && data[grid_size + 1] == 0);
+
+  // One target: count, six words describing it and four bytes of directions per row
+  CHECK(nav_section_size(tube, "--flow-fields", &data, &out) == grid_size + 2 + 12 + 8 * 4);
+  CHECK(data && data[grid_size] == 0 && data[grid_size + 1] == 1);
+}
+
+int main()
+{
+  check_fields();
+  check_section();
+
+  return test_result("test_nav_grid");
+}
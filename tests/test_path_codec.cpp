@@ -0,0 +1,75 @@
+#include <string.h>
+#include "test_util.h"
+#include "path_codec.h"
+#include "convert.h"
+
+// Decoding an encoded path must give back every point, whatever the size of the steps
+static void check_round_trip()
+{
+  unsigned seed = 5;
+  const int step_limits[] = { 4, 130, 300, 40000 };
+
+  for (unsigned int s = 0; s < sizeof(step_limits) / sizeof(step_limits[0]); s++) {
+    std::vector<Tmx::Point> points;
+    Tmx::Point point = { 100, 200 };
+    for (int i = 0; i < 500; i++) {
+      const int kind = test_rand(&seed) % 3;
+      const int dx = kind == 2 ? 0 : (int) (test_rand(&seed) % (2 * step_limits[s])) - step_limits[s];
+      const int dy = kind == 1 ? 0 : (int) (test_rand(&seed) % (2 * step_limits[s])) - step_limits[s];
+      point.x = (short) (point.x + dx);
+      point.y = (short) (point.y + dy);
+      points.push_back(point);
+    }
+
+    lev_buffer buf;
+    const int size = path_encode(points, &buf);
+    CHECK(size == (int) buf.data.size());
+
+    std::vector<Tmx::Point> decoded;
+    CHECK(path_decode(&buf.data[0], buf.data.size(), &decoded) == size);
+    CHECK(decoded.size() == points.size());
+    for (unsigned int i = 0; i < points.size() && i < decoded.size(); i++) {
+      CHECK(decoded[i].x == points[i].x && decoded[i].y == points[i].y);
+    }
+
+    // Truncated data is reported, not read past
+    CHECK(path_decode(&buf.data[0], buf.data.size() - 1, &decoded) == -1);
+  }
+}
+
+// The number of points of a compact path is a word, longer polylines must be refused
+static void check_point_limit()
+{
+  for (int num_points = PATH_MAX_POINTS; num_points <= PATH_MAX_POINTS + 1; num_points++) {
+    std::string points;
+    char text[32];
+    for (int i = 0; i < num_points; i++) {
+      snprintf(text, sizeof(text), i ? " %d,%d" : "%d,%d", i % 64, i / 64);
+      points += text;
+    }
+
+    std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(16, 1));
+    const std::string objects = "<objectgroup name=\"objects\"><object id=\"1\" type=\"npc\" x=\"8\" y=\"8\">"
+                                "<polyline points=\"" + points + "\"/></object></objectgroup>\n";
+    Tmx::Map *map = test_parse_map(test_map_text(4, 4, 1, test_tile_text(0, "floor", 0), layers, objects));
+
+    convert_options opts;
+    convert_options_init(&opts);
+    const char *args[] = { "--compact-paths" };
+    CHECK(convert_parse_options(&opts, 1, args, NULL));
+
+    lev_buffer out;
+    const int status = convert_level(map, &opts, &out, NULL);
+    CHECK(num_points <= PATH_MAX_POINTS ? status == 0 : status != 0);
+
+    delete map;
+  }
+}
+
+int main()
+{
+  check_round_trip();
+  check_point_limit();
+
+  return test_result("test_path_codec");
+}
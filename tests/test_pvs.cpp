@@ -0,0 +1,126 @@
+#include "test_util.h"
+#include "pvs.h"
+
+// 3x2 regions of 4x4 cells. A wall runs down the first column of region column 1,
+// a sealed room in region (2, 0) holds object 0.
+static const int drawn_width = 12;
+static const int drawn_height = 8;
+static const char *drawn[drawn_height] = {
+  "....#.......",
+  ".1..#.......",
+  "....#...###.",
+  "....#...#0#.",
+  "....#...###.",
+  "....#.......",
+  "....#.2.....",
+  "....#.......",
+};
+
+static void build(pvs_table *pvs, const std::vector<unsigned char> &solid, int width, int height,
+                  int region_width, int region_height, const std::vector<pvs_object> &objects, int num_threads)
+{
+  Tmx::Util::SetNumThreads(num_threads);
+  pvs_build(pvs, solid, width, height, region_width, region_height, objects);
+  Tmx::Util::SetNumThreads(0);
+}
+
+static unsigned short neighbours(int dx, int dy)
+{
+  return 1 << ((dy + 1) * 3 + (dx + 1));
+}
+
+static void check_drawn()
+{
+  std::vector<unsigned char> solid;
+  std::vector<pvs_object> objects(3);
+  for (int y = 0; y < drawn_height; y++) {
+    for (int x = 0; x < drawn_width; x++) {
+      solid.push_back(drawn[y][x] == '#');
+      if (drawn[y][x] >= '0' && drawn[y][x] <= '9') {
+        objects[drawn[y][x] - '0'].x = x;
+        objects[drawn[y][x] - '0'].y = y;
+      }
+    }
+  }
+
+  pvs_table pvs;
+  build(&pvs, solid, drawn_width, drawn_height, 4, 4, objects, 1);
+  CHECK(pvs.cols == 3 && pvs.rows == 2 && pvs.num_objects == 3 && pvs.object_bytes == 2);
+
+  // Looking right the wall is seen, looking left from behind it nothing is,
+  // and the sealed room is only seen from the region it lies in
+  const unsigned short below_right = neighbours(0, 0) | neighbours(1, 0) | neighbours(0, 1) | neighbours(1, 1);
+  const unsigned short below_left = neighbours(0, 0) | neighbours(-1, 0) | neighbours(0, 1) | neighbours(-1, 1);
+  const unsigned short above_right = neighbours(0, 0) | neighbours(1, 0) | neighbours(0, -1) | neighbours(1, -1);
+  const unsigned short above_left = neighbours(0, 0) | neighbours(-1, 0) | neighbours(0, -1) | neighbours(-1, -1);
+  const unsigned short masks[2][3] = { { below_right, below_right, below_left }, { above_right, above_right, above_left } };
+  const unsigned char bits[2][3] = { { 0x40, 0x20, 0xa0 }, { 0x40, 0x20, 0x20 } };
+
+  for (int row = 0; row < 2; row++) {
+    for (int col = 0; col < 3; col++) {
+      CHECK(pvs_region_mask(&pvs, col, row) == masks[row][col]);
+      const unsigned char *objs = pvs_region_objects(&pvs, col, row);
+      CHECK(objs[0] == bits[row][col] && objs[1] == 0);
+    }
+  }
+
+  // Without objects there is no object bitset
+  build(&pvs, solid, drawn_width, drawn_height, 4, 4, std::vector<pvs_object>(), 1);
+  CHECK(pvs.object_bytes == 0 && pvs_region_objects(&pvs, 0, 0) == NULL);
+}
+
+// Bands of rows of regions built in parallel must give the tables of the serial build,
+// and an object in a sealed room stays hidden from every other region
+static void check_parallel()
+{
+  unsigned seed = 46;
+  const int width = 67;
+  const int height = 61;
+  const int thread_counts[] = { 2, 3, 7, 16 };
+
+  std::vector<unsigned char> solid;
+  for (int i = 0; i < width * height; i++) {
+    solid.push_back(test_rand(&seed) % 100 < 30);
+  }
+  for (int y = 30; y < 33; y++) {
+    for (int x = 40; x < 43; x++) {
+      solid[y * width + x] = x != 41 || y != 31;
+    }
+  }
+
+  // Objects partly off the map count as being on its edge
+  std::vector<pvs_object> objects;
+  pvs_object room = { 41, 31 };
+  objects.push_back(room);
+  for (int i = 0; i < 37; i++) {
+    pvs_object object = { (int) (test_rand(&seed) % (width + 8)) - 4, (int) (test_rand(&seed) % (height + 8)) - 4 };
+    objects.push_back(object);
+  }
+
+  pvs_table serial;
+  build(&serial, solid, width, height, 5, 2, objects, 1);
+  CHECK(serial.rows == 31 && serial.object_bytes == 6);
+
+  for (int row = 0; row < serial.rows; row++) {
+    for (int col = 0; col < serial.cols; col++) {
+      const bool own = col == 41 / 5 && row == 31 / 2;
+      CHECK(((pvs_region_objects(&serial, col, row)[0] & 0x80) != 0) == own);
+    }
+  }
+
+  for (unsigned int t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+    pvs_table parallel;
+    build(&parallel, solid, width, height, 5, 2, objects, thread_counts[t]);
+    CHECK(parallel.cols == serial.cols && parallel.rows == serial.rows);
+    CHECK(parallel.masks == serial.masks);
+    CHECK(parallel.objects == serial.objects);
+  }
+}
+
+int main()
+{
+  check_drawn();
+  check_parallel();
+
+  return test_result("test_pvs");
+}
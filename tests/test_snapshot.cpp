@@ -0,0 +1,184 @@
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include "test_util.h"
+
+// Map with flipped tiles, holes, an infinite layer, an animated tile and shaped objects
+static std::string snapshot_map_text()
+{
+  const unsigned h = Tmx::FlippedHorizontallyFlag;
+  const unsigned v = Tmx::FlippedVerticallyFlag;
+  const unsigned d = Tmx::FlippedDiagonallyFlag;
+  char text[64];
+
+  std::string csv;
+  for (int i = 0; i < 8 * 6; i++) {
+    const unsigned flips[] = { 0, h, v, d, h | v, h | d, v | d, h | v | d };
+    const unsigned gid = (i % 5 == 0) ? 0 : ((i * 7) % 12 + 1) | flips[i % 8];
+    snprintf(text, sizeof(text), i ? ",%u" : "%u", gid);
+    csv += text;
+  }
+
+  std::string chunk;
+  for (int i = 0; i < 16 * 16; i++) {
+    snprintf(text, sizeof(text), i ? ",%u" : "%u", (i % 3) ? (i % 12 + 1) | (i % 2 ? h : v) : 0);
+    chunk += text;
+  }
+
+  return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         "<map version=\"1.2\" orientation=\"orthogonal\" width=\"8\" height=\"6\" tilewidth=\"16\" tileheight=\"16\">\n"
+         "<properties><property name=\"ambient\" value=\"40\"/></properties>\n"
+         "<tileset firstgid=\"1\" name=\"a\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"8\">\n"
+         "<tile id=\"2\"><properties><property name=\"type\" value=\"rock\"/><property name=\"mask\" value=\"ff\"/></properties>"
+         "<animation><frame tileid=\"2\" duration=\"100\"/><frame tileid=\"3\" duration=\"250\"/></animation></tile>\n"
+         "</tileset>\n"
+         "<tileset firstgid=\"9\" name=\"b\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"4\"/>\n"
+         "<layer name=\"dense\" width=\"8\" height=\"6\"><data encoding=\"csv\">" + csv + "</data></layer>\n"
+         "<layer name=\"chunked\" width=\"8\" height=\"6\"><data encoding=\"csv\">"
+         "<chunk x=\"-16\" y=\"0\" width=\"16\" height=\"16\">" + chunk + "</chunk>"
+         "<chunk x=\"16\" y=\"16\" width=\"16\" height=\"16\">" + chunk + "</chunk></data></layer>\n"
+         "<objectgroup name=\"objects\">"
+         "<object id=\"1\" name=\"walker\" type=\"npc\" x=\"10\" y=\"20\"><properties><property name=\"index\" value=\"3\"/></properties>"
+         "<polyline points=\"0,0 40,0 40,-30\"/></object>"
+         "<object id=\"2\" type=\"static\" x=\"64\" y=\"32\"><polygon points=\"0,0 16,0 8,12\"/></object>"
+         "</objectgroup>\n"
+         "</map>\n";
+}
+
+static std::string temp_name(const char *tag)
+{
+  char name[64];
+  snprintf(name, sizeof(name), "/tmp/test_snapshot_%d_%s", (int) getpid(), tag);
+  return name;
+}
+
+static std::vector<char> read_file(const std::string &name)
+{
+  std::ifstream file(name.c_str(), std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void compare_layers(const Tmx::Layer *a, const Tmx::Layer *b)
+{
+  CHECK(a->GetName() == b->GetName());
+  CHECK(a->GetWidth() == b->GetWidth() && a->GetHeight() == b->GetHeight());
+  CHECK(a->IsChunked() == b->IsChunked());
+  CHECK(a->GetOriginX() == b->GetOriginX() && a->GetOriginY() == b->GetOriginY());
+  if (a->GetWidth() != b->GetWidth() || a->GetHeight() != b->GetHeight()) {
+    return;
+  }
+
+  for (int y = 0; y < a->GetHeight(); y++) {
+    for (int x = 0; x < a->GetWidth(); x++) {
+      const Tmx::MapTile &ta = a->GetTile(x, y);
+      const Tmx::MapTile &tb = b->GetTile(x, y);
+      CHECK(ta.tilesetId == tb.tilesetId);
+      CHECK(ta.tilesetId < 0 || ta.id == tb.id);
+      CHECK(ta.flippedHorizontally == tb.flippedHorizontally);
+      CHECK(ta.flippedVertically == tb.flippedVertically);
+      CHECK(ta.flippedDiagonally == tb.flippedDiagonally);
+    }
+  }
+}
+
+static void compare_maps(const Tmx::Map *a, const Tmx::Map *b)
+{
+  CHECK(a->GetWidth() == b->GetWidth() && a->GetHeight() == b->GetHeight());
+  CHECK(a->GetProperties().GetList() == b->GetProperties().GetList());
+
+  CHECK(a->GetNumTilesets() == b->GetNumTilesets());
+  for (int i = 0; i < a->GetNumTilesets() && i < b->GetNumTilesets(); i++) {
+    const Tmx::Tileset *ta = a->GetTileset(i);
+    const Tmx::Tileset *tb = b->GetTileset(i);
+    CHECK(ta->GetName() == tb->GetName() && ta->GetFirstGid() == tb->GetFirstGid());
+    CHECK(ta->GetTiles().size() == tb->GetTiles().size());
+
+    for (unsigned int j = 0; j < ta->GetTiles().size() && j < tb->GetTiles().size(); j++) {
+      const Tmx::Tile &tile_a = ta->GetTiles()[j];
+      const Tmx::Tile &tile_b = tb->GetTiles()[j];
+      CHECK(tile_a.GetId() == tile_b.GetId());
+      CHECK(tile_a.GetProperties().GetList() == tile_b.GetProperties().GetList());
+      CHECK(tile_a.GetFrames().size() == tile_b.GetFrames().size());
+      for (unsigned int k = 0; k < tile_a.GetFrames().size() && k < tile_b.GetFrames().size(); k++) {
+        CHECK(tile_a.GetFrames()[k].tile_id == tile_b.GetFrames()[k].tile_id);
+        CHECK(tile_a.GetFrames()[k].duration == tile_b.GetFrames()[k].duration);
+      }
+    }
+  }
+
+  CHECK(a->GetNumLayers() == b->GetNumLayers());
+  for (int i = 0; i < a->GetNumLayers() && i < b->GetNumLayers(); i++) {
+    compare_layers(a->GetLayer(i), b->GetLayer(i));
+  }
+
+  CHECK(a->GetNumObjectGroups() == b->GetNumObjectGroups());
+  for (int i = 0; i < a->GetNumObjectGroups() && i < b->GetNumObjectGroups(); i++) {
+    const Tmx::ObjectGroup *ga = a->GetObjectGroup(i);
+    const Tmx::ObjectGroup *gb = b->GetObjectGroup(i);
+    CHECK(ga->GetName() == gb->GetName() && ga->GetNumObjects() == gb->GetNumObjects());
+
+    for (int j = 0; j < ga->GetNumObjects() && j < gb->GetNumObjects(); j++) {
+      const Tmx::Object *oa = ga->GetObject(j);
+      const Tmx::Object *ob = gb->GetObject(j);
+      CHECK(oa->GetName() == ob->GetName() && oa->GetType() == ob->GetType());
+      CHECK(oa->GetX() == ob->GetX() && oa->GetY() == ob->GetY());
+      CHECK(oa->GetProperties().GetList() == ob->GetProperties().GetList());
+      CHECK((oa->GetPolyline() == NULL) == (ob->GetPolyline() == NULL));
+      CHECK((oa->GetPolygon() == NULL) == (ob->GetPolygon() == NULL));
+      if (oa->GetPolyline() && ob->GetPolyline()) {
+        CHECK(oa->GetPolyline()->GetNumPoints() == ob->GetPolyline()->GetNumPoints());
+        for (int k = 0; k < oa->GetPolyline()->GetNumPoints() && k < ob->GetPolyline()->GetNumPoints(); k++) {
+          CHECK(oa->GetPolyline()->GetPoint(k).x == ob->GetPolyline()->GetPoint(k).x);
+          CHECK(oa->GetPolyline()->GetPoint(k).y == ob->GetPolyline()->GetPoint(k).y);
+        }
+      }
+      if (oa->GetPolygon() && ob->GetPolygon()) {
+        CHECK(oa->GetPolygon()->GetNumPoints() == ob->GetPolygon()->GetNumPoints());
+      }
+    }
+  }
+}
+
+int main()
+{
+  const std::string text = snapshot_map_text();
+  const std::string first = temp_name("first");
+  const std::string second = temp_name("second");
+  const std::string again = temp_name("again");
+
+  // Parse -> save -> load must give back the parsed map
+  Tmx::Map *parsed = test_parse_map(text);
+  CHECK(parsed->SaveSnapshot(first));
+
+  Tmx::Map loaded;
+  loaded.LoadSnapshot(first);
+  CHECK(!loaded.HasError());
+  compare_maps(parsed, &loaded);
+
+  // Two parses of the same map must give identical snapshots, and saving a loaded map must too
+  Tmx::Map *reparsed = test_parse_map(text);
+  CHECK(reparsed->SaveSnapshot(second));
+  CHECK(loaded.SaveSnapshot(again));
+
+  const std::vector<char> data = read_file(first);
+  CHECK(!data.empty());
+  CHECK(data == read_file(second));
+  CHECK(data == read_file(again));
+
+  // A truncated snapshot must be reported, not loaded
+  {
+    std::ofstream file(second.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(&data[0], data.size() / 2);
+  }
+  Tmx::Map truncated;
+  truncated.LoadSnapshot(second);
+  CHECK(truncated.HasError());
+
+  unlink(first.c_str());
+  unlink(second.c_str());
+  unlink(again.c_str());
+  delete parsed;
+  delete reparsed;
+
+  return test_result("test_snapshot");
+}
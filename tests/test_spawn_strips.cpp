@@ -0,0 +1,72 @@
+#include "test_util.h"
+#include "spawn_strips.h"
+
+// Every object must appear in exactly one strip, the strip its clamped position falls in
+static void check_strips(int num_objects, int strip_size, int extent, unsigned *seed)
+{
+  std::vector<int> positions(num_objects);
+  for (int i = 0; i < num_objects; i++) {
+    // Include positions left of and beyond the map, and many ties
+    positions[i] = (int) (test_rand(seed) % (extent + 400)) - 200;
+    if (test_rand(seed) % 4 == 0) {
+      positions[i] = positions[test_rand(seed) % (i + 1)];
+    }
+  }
+
+  std::vector<int> order;
+  std::vector<spawn_strip> strips;
+  spawn_sort(&order, positions);
+  spawn_strips_build(&strips, order, positions, strip_size, extent);
+
+  const int num_strips = strips.size();
+  CHECK(num_strips == (extent + strip_size - 1) / strip_size || (extent <= 0 && num_strips == 1));
+
+  std::vector<int> seen(num_objects, 0);
+  int next = 0;
+  for (int s = 0; s < num_strips; s++) {
+    CHECK(strips[s].first == next);
+    CHECK(strips[s].count >= 0);
+
+    for (int k = strips[s].first; k < strips[s].first + strips[s].count && k < num_objects; k++) {
+      const int object = order[k];
+      seen[object]++;
+
+      int expected = positions[object] < 0 ? 0 : positions[object] / strip_size;
+      if (expected >= num_strips) {
+        expected = num_strips - 1;
+      }
+      CHECK(expected == s);
+
+      // Sorted by position, document order kept for ties
+      if (k > 0) {
+        const int prev = order[k - 1];
+        CHECK(positions[prev] < positions[object] || (positions[prev] == positions[object] && prev < object));
+      }
+    }
+
+    next += strips[s].count;
+  }
+
+  CHECK(next == num_objects);
+  for (int i = 0; i < num_objects; i++) {
+    CHECK(seen[i] == 1);
+  }
+}
+
+int main()
+{
+  unsigned seed = 11;
+  const int strip_sizes[] = { 1, 16, 100, 256, 5000 };
+  const int extents[] = { 0, 1, 255, 256, 257, 4096 };
+  const int counts[] = { 0, 1, 2, 50, 1000 };
+
+  for (unsigned int i = 0; i < sizeof(strip_sizes) / sizeof(strip_sizes[0]); i++) {
+    for (unsigned int j = 0; j < sizeof(extents) / sizeof(extents[0]); j++) {
+      for (unsigned int k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+        check_strips(counts[k], strip_sizes[i], extents[j], &seed);
+      }
+    }
+  }
+
+  return test_result("test_spawn_strips");
+}
@@ -0,0 +1,117 @@
+#include <string.h>
+#include "test_util.h"
+#include "tile_stats.h"
+
+// Statistics gathered cell by cell, the way the definition reads
+static void reference_stats(tile_stats *stats, const Tmx::Layer *layer, int width, int height)
+{
+  memset(stats, 0, sizeof(*stats));
+  stats->min_id = ~0u;
+  stats->cells = width * height;
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const Tmx::MapTile &tile = layer->GetTile(x, y);
+      if (tile.tilesetId < 0) {
+        stats->empty++;
+        continue;
+      }
+
+      int bin = 0;
+      for (unsigned id = tile.id; id; id >>= 1) {
+        bin++;
+      }
+
+      stats->min_id = tile.id < stats->min_id ? tile.id : stats->min_id;
+      stats->max_id = tile.id > stats->max_id ? tile.id : stats->max_id;
+      stats->bins[bin]++;
+    }
+  }
+
+  if (stats->empty == stats->cells) {
+    stats->min_id = 0;
+  }
+}
+
+static void compare_stats(const Tmx::Layer *layer)
+{
+  tile_stats stats;
+  tile_stats expected;
+  tile_stats_build(&stats, layer, layer->GetWidth(), layer->GetHeight());
+  reference_stats(&expected, layer, layer->GetWidth(), layer->GetHeight());
+
+  CHECK(stats.min_id == expected.min_id);
+  CHECK(stats.max_id == expected.max_id);
+  CHECK(stats.cells == expected.cells);
+  CHECK(stats.empty == expected.empty);
+  for (int i = 0; i < TILE_STATS_BINS; i++) {
+    CHECK(stats.bins[i] == expected.bins[i]);
+  }
+}
+
+// Gids around powers of two, where the bit length changes, with flips and holes
+static unsigned random_gid(unsigned *seed)
+{
+  const unsigned flips = (test_rand(seed) & 7) << 29;
+  switch (test_rand(seed) % 4) {
+  case 0:
+    return 0;
+  case 1:
+    return (test_rand(seed) % 300 + 1) | flips;
+  default: {
+    const unsigned power = 1u << (test_rand(seed) % 29);
+    const unsigned gid = power + (test_rand(seed) % 3) - 1;
+    return (gid > 0x1fffffff ? 0x1fffffff : gid < 2 ? 2 : gid) | flips;
+  }
+  }
+}
+
+int main()
+{
+  unsigned seed = 19;
+  const int widths[] = { 1, 3, 4, 5, 17, 64 };
+
+  // Dense layers, including ones with only holes and widths that leave a tail after every block of four
+  for (unsigned int w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+    for (int holes_only = 0; holes_only < 2; holes_only++) {
+      const int width = widths[w];
+      const int height = 7;
+      std::vector< std::vector<unsigned> > layers(1);
+      for (int i = 0; i < width * height; i++) {
+        layers[0].push_back(holes_only ? 0 : random_gid(&seed));
+      }
+
+      Tmx::Map *map = test_parse_map(test_map_text(width, height, 4, "", layers, ""));
+      CHECK(map->GetLayer(0)->GetTileData() != NULL);
+      compare_stats(map->GetLayer(0));
+
+      std::string text;
+      tile_stats stats;
+      tile_stats_build(&stats, map->GetLayer(0), width, height);
+      tile_stats_format(&stats, &text);
+      CHECK(holes_only ? text.compare(0, 6, "no ids") == 0 : text.compare(0, 4, "ids ") == 0);
+
+      delete map;
+    }
+  }
+
+  // A chunked layer goes through the cell by cell path
+  std::string chunk;
+  char text[32];
+  for (int i = 0; i < 16 * 16; i++) {
+    snprintf(text, sizeof(text), i ? ",%u" : "%u", random_gid(&seed));
+    chunk += text;
+  }
+  const std::string infinite = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<map version=\"1.2\" orientation=\"orthogonal\" width=\"20\" height=\"20\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+    "<tileset firstgid=\"1\" name=\"t\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"4\"/>\n"
+    "<layer name=\"l\" width=\"20\" height=\"20\"><data encoding=\"csv\">"
+    "<chunk x=\"0\" y=\"0\" width=\"16\" height=\"16\">" + chunk + "</chunk>"
+    "<chunk x=\"16\" y=\"16\" width=\"16\" height=\"16\">" + chunk + "</chunk></data></layer>\n</map>\n";
+  Tmx::Map *map = test_parse_map(infinite);
+  CHECK(map->GetLayer(0)->GetTileData() == NULL);
+  compare_stats(map->GetLayer(0));
+  delete map;
+
+  return test_result("test_tile_stats");
+}
@@ -0,0 +1,57 @@
+#include <string.h>
+#include "test_util.h"
+#include "level_types.h"
+#include "type_schema.h"
+
+struct schema_row
+{
+  enum type_kind kind;
+  const char *name;
+  int code;
+};
+
+static const schema_row rows[] = {
+#define TILE_TYPE(constant, name, code) { TYPE_KIND_TILE, name, code },
+#define OBJECT_TYPE(constant, name, code) { TYPE_KIND_OBJECT, name, code },
+#define AREA_TYPE(constant, name, code) { TYPE_KIND_AREA, name, code },
+#define DIRECTION(constant, name, code) { TYPE_KIND_DIRECTION, name, code },
+#include "level_types.def"
+};
+
+int main()
+{
+  const int num_rows = sizeof(rows) / sizeof(rows[0]);
+  CHECK(type_schema_failed_kind() == -1);
+  int num_directions = 0;
+
+  // Every name of the schema gives its own code, and is known only to the kinds listing it
+  for (int i = 0; i < num_rows; i++) {
+    CHECK(type_known(rows[i].kind, rows[i].name));
+    CHECK(type_lookup(rows[i].kind, rows[i].name, -1) == rows[i].code);
+
+    for (int k = 0; k < MAX_TYPE_KIND; k++) {
+      bool listed = false;
+      for (int j = 0; j < num_rows; j++) {
+        listed = listed || (rows[j].kind == k && strcmp(rows[j].name, rows[i].name) == 0);
+      }
+      CHECK(type_known((enum type_kind) k, rows[i].name) == listed);
+    }
+
+    if (rows[i].kind == TYPE_KIND_DIRECTION) {
+      num_directions++;
+    }
+  }
+
+  // Directions are numbered from 0 on, MAX_DIRECTION being the unknown one
+  CHECK(num_directions == MAX_DIRECTION);
+  CHECK(get_direction("NW") == NW && get_direction("nw") == MAX_DIRECTION);
+  CHECK(get_area_type("door") == AREA_TYPE_DOOR && get_area_type("") == AREA_TYPE_UNKNOWN);
+  CHECK(get_object_type("savetube") == OBJECT_TYPE_SAVETUBE && get_object_type("savetubes") == OBJECT_TYPE_UNKNOWN);
+
+  for (int k = 0; k < MAX_TYPE_KIND; k++) {
+    CHECK(!type_known((enum type_kind) k, "no such type"));
+    CHECK(type_lookup((enum type_kind) k, "", 77) == 77);
+  }
+
+  return test_result("test_type_schema");
+}
@@ -0,0 +1,91 @@
+#ifndef _TEST_UTIL_H
+#define _TEST_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "Tmx.h"
+
+static int test_failures = 0;
+
+// Report a failed condition with its location and keep going
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      test_failures++; \
+    } \
+  } while (0)
+
+// Exit status of a test program, with a summary line
+inline int test_result(const char *name)
+{
+  if (test_failures) {
+    printf("%s: %d check(s) failed\n", name, test_failures);
+    return 1;
+  }
+
+  printf("%s: OK\n", name);
+  return 0;
+}
+
+// Deterministic random numbers, so failures can be reproduced
+inline unsigned test_rand(unsigned *state)
+{
+  *state = *state * 1103515245u + 12345u;
+  return (*state >> 16) & 0x7fff;
+}
+
+// Text of a tile with a type and a hexadecimal mask, for test_map_text
+inline std::string test_tile_text(int id, const char *type, int mask)
+{
+  char text[256];
+  snprintf(text, sizeof(text), "<tile id=\"%d\"><properties><property name=\"type\" value=\"%s\"/>"
+           "<property name=\"mask\" value=\"%x\"/></properties></tile>\n", id, type, mask);
+  return text;
+}
+
+// Text of an orthogonal map of 16x16 pixel tiles with one tileset of num_tiles tiles and csv layers of gids.
+// Extra text, such as object groups, is added after the layers.
+inline std::string test_map_text(int width, int height, int num_tiles, const std::string &tiles,
+                                 const std::vector< std::vector<unsigned> > &layers, const std::string &extra)
+{
+  char text[512];
+  snprintf(text, sizeof(text), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"16\" tileheight=\"16\">\n"
+           "<tileset firstgid=\"1\" name=\"t\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"%d\">\n",
+           width, height, num_tiles);
+  std::string map = text;
+  map += tiles;
+  map += "</tileset>\n";
+
+  for (unsigned int i = 0; i < layers.size(); i++) {
+    snprintf(text, sizeof(text), "<layer name=\"l%u\" width=\"%d\" height=\"%d\"><data encoding=\"csv\">", i, width, height);
+    map += text;
+    for (unsigned int j = 0; j < layers[i].size(); j++) {
+      snprintf(text, sizeof(text), j ? ",%u" : "%u", layers[i][j]);
+      map += text;
+    }
+    map += "</data></layer>\n";
+  }
+
+  map += extra;
+  map += "</map>\n";
+  return map;
+}
+
+// Parse map text, exiting on a parse error since nothing else can be checked
+inline Tmx::Map* test_parse_map(const std::string &text)
+{
+  Tmx::Map *map = new Tmx::Map();
+  map->ParseText(text, "./");
+  if (map->HasError()) {
+    printf("map parse error: %s\n", map->GetErrorText().c_str());
+    exit(1);
+  }
+
+  return map;
+}
+
+#endif
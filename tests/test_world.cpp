@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "test_util.h"
+#include "world.h"
+#include "convert.h"
+
+// Door area of one tile leading to a start tile of another level
+static std::string door_text(int id, int x, int y, int level, int start_x, int start_y)
+{
+  char text[512];
+  snprintf(text, sizeof(text), "<object id=\"%d\" type=\"door\" x=\"%d\" y=\"%d\" width=\"16\" height=\"16\"><properties>"
+           "<property name=\"level\" value=\"%d\"/><property name=\"start_x\" value=\"%d\"/>"
+           "<property name=\"start_y\" value=\"%d\"/></properties></object>\n", id, x, y, level, start_x, start_y);
+  return text;
+}
+
+// Infinite map of one 4x4 chunk at tile (x, y), so it is cropped with that origin.
+// The top left tile is empty, every other one is floor.
+static std::string infinite_level_text(int x, int y, const std::string &doors)
+{
+  char chunk[128];
+  snprintf(chunk, sizeof(chunk), "<chunk x=\"%d\" y=\"%d\" width=\"4\" height=\"4\">", x, y);
+  return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         "<map version=\"1.2\" orientation=\"orthogonal\" width=\"4\" height=\"4\" tilewidth=\"16\" tileheight=\"16\" infinite=\"1\">\n"
+         "<tileset firstgid=\"1\" name=\"t\" tilewidth=\"16\" tileheight=\"16\" tilecount=\"1\">\n"
+         + test_tile_text(0, "floor", 0) + "</tileset>\n"
+         "<layer name=\"l0\" width=\"4\" height=\"4\"><data encoding=\"csv\">\n"
+         + chunk + "0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1</chunk>\n"
+         "</data></layer>\n"
+         "<objectgroup name=\"areas\">" + doors + "</objectgroup>\n</map>\n";
+}
+
+static bool write_text(const std::string &name, const std::string &text)
+{
+  FILE *fp = fopen(name.c_str(), "w");
+  if (!fp) {
+    return false;
+  }
+
+  const bool ok = fwrite(text.data(), 1, text.size(), fp) == text.size();
+  return fclose(fp) == 0 && ok;
+}
+
+static void append_log(const char *text, void *user)
+{
+  ((std::string *) user)->append(text);
+}
+
+static int read_word(const unsigned char *data)
+{
+  return (short) ((data[0] << 8) | data[1]);
+}
+
+// Start of area i of a map converted to a container, (0, 0) without that area
+static std::pair<int, int> area_start(const std::string &text, int i)
+{
+  Tmx::Map *map = test_parse_map(text);
+  convert_options opts;
+  convert_options_init(&opts);
+  const char *args[] = { "--container" };
+  CHECK(convert_parse_options(&opts, 1, args, NULL));
+
+  lev_buffer out;
+  lev_entry entry;
+  const unsigned char *areas = NULL;
+  CHECK(convert_level(map, &opts, &out, NULL) == 0);
+  if (!out.data.empty()) {
+    areas = lev_find_section(&out.data[0], out.data.size(), LEV_SECTION_AREAS, &entry);
+  }
+  delete map;
+
+  // Count word, then 16 bytes per area: type byte, level, start x and start y words, ...
+  const unsigned char *area = areas ? areas + 2 + i * 16 : NULL;
+  if (!areas || entry.size < (unsigned) (2 + (i + 1) * 16) || read_word(&areas[0]) <= i) {
+    return std::make_pair(0, 0);
+  }
+
+  return std::make_pair(read_word(&area[3]), read_word(&area[5]));
+}
+
+// Start tiles are given in tiles of the map a door leads to and must be checked and
+// written relative to the cropped tiles of that level
+static void check_world(const std::string &dir)
+{
+  std::vector< std::vector<unsigned> > layers(1, std::vector<unsigned>(8 * 8, 1));
+  const std::string level0 = test_map_text(8, 8, 1, test_tile_text(0, "floor", 0), layers,
+                                           "<objectgroup name=\"areas\">" + door_text(1, 16, 16, 1, -7, -3) +
+                                           door_text(2, 48, 48, 1, -8, -4) + "</objectgroup>\n");
+  const std::string level1 = infinite_level_text(-8, -4, door_text(1, -5 * 16, -2 * 16, 1, -7, -3) +
+                                                 door_text(2, -6 * 16, -2 * 16, 2, 3, 7));
+  const std::string level2 = infinite_level_text(2, 6, door_text(1, 3 * 16, 7 * 16, 0, 2, 2));
+
+  std::vector<std::string> files;
+  files.push_back(dir + "/level0.tmx");
+  files.push_back(dir + "/level1.tmx");
+  files.push_back(dir + "/level2.tmx");
+  CHECK(write_text(files[0], level0) && write_text(files[1], level1) && write_text(files[2], level2));
+
+  std::vector<world_level> levels;
+  CHECK(world_load(&levels, files, "areas"));
+  if (levels.size() != 3 || !levels[0].error.empty() || !levels[1].error.empty() || !levels[2].error.empty()) {
+    CHECK(false);
+    return;
+  }
+
+  CHECK(levels[0].origin_x == 0 && levels[0].origin_y == 0);
+  CHECK(levels[1].origin_x == -8 && levels[1].origin_y == -4);
+  CHECK(levels[2].origin_x == 2 && levels[2].origin_y == 6);
+  CHECK(levels[1].width == 4 && levels[1].height == 4);
+  CHECK(levels[1].doors.size() == 2 && levels[1].doors[0].x == 3 * 16 && levels[1].doors[0].y == 2 * 16);
+
+  // The second door of level 0 leads to the empty tile, the other doors to floor
+  std::string text;
+  convert_log log = { append_log, &text };
+  CHECK(world_validate(levels, &log) == 1);
+  CHECK(text == "level 0: door area 1 leads to (-8, -4) of level 1, which is not a walkable tile\n");
+  levels[0].doors.pop_back();
+  CHECK(world_validate(levels, NULL) == 0);
+
+  lev_buffer level_buf;
+  lev_buffer door_buf;
+  world_write_index(levels, &level_buf, &door_buf);
+
+  // Nine words per door, the start at words 6 and 7. Doors into levels 1 and 2 lead to
+  // their tile (1, 1), the door into level 0 to its tile (2, 2).
+  const int starts[4] = { 1, 1, 1, 2 };
+  CHECK(door_buf.data.size() == 4 * 9 * 2);
+  if (door_buf.data.size() == 4 * 9 * 2) {
+    for (int i = 0; i < 4; i++) {
+      CHECK(read_word(&door_buf.data[i * 18 + 12]) == starts[i]);
+      CHECK(read_word(&door_buf.data[i * 18 + 14]) == starts[i]);
+    }
+  }
+
+  // The level files keep the start as drawn, whatever the crop of either level,
+  // and the world index alone moves it to the tiles of the level it leads to
+  CHECK(area_start(level0, 0) == std::make_pair(-7, -3));
+  CHECK(area_start(level1, 0) == std::make_pair(-7, -3));
+  CHECK(area_start(level1, 1) == std::make_pair(3, 7));
+  CHECK(area_start(level2, 0) == std::make_pair(2, 2));
+
+  for (unsigned int i = 0; i < files.size(); i++) {
+    remove(files[i].c_str());
+  }
+}
+
+int main()
+{
+  char dir[] = "/tmp/test_world_XXXXXX";
+  if (!mkdtemp(dir)) {
+    printf("test_world: can not create a directory for the maps\n");
+    return 1;
+  }
+
+  check_world(dir);
+  rmdir(dir);
+
+  return test_result("test_world");
+}
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "tile_stats.h"
+
+static inline int tile_stats_bin(unsigned id)
+{
+  return id ? 32 - __builtin_clz(id) : 0;
+}
+
+// Running statistics of the non-empty cells seen so far
+struct tile_stats_acc
+{
+  unsigned min_id;
+  unsigned max_id;
+  int empty;
+  int *bins;
+};
+
+static inline void tile_stats_add(tile_stats_acc *acc, const Tmx::MapTile &tile)
+{
+  if (tile.tilesetId < 0) {
+    acc->empty++;
+    return;
+  }
+
+  acc->min_id = tile.id < acc->min_id ? tile.id : acc->min_id;
+  acc->max_id = tile.id > acc->max_id ? tile.id : acc->max_id;
+  acc->bins[tile_stats_bin(tile.id)]++;
+}
+
+// Add count contiguous tiles.
+// With SSE2 four 12-byte tiles are loaded as three registers and shuffled into a register of
+// tileset ids and one of ids. Ids never have the flip bits set, so they compare as signed values.
+// The bit length of an id is read from the exponent of the id as a float, after dropping bits
+// that could round it up to the next power of two.
+static void tile_stats_scan(tile_stats_acc *acc, const Tmx::MapTile *tiles, int count)
+{
+  int i = 0;
+
+#if defined(__SSE2__)
+  static_assert(sizeof(Tmx::MapTile) == 3 * sizeof(int), "MapTile layout assumed by the SSE2 scan");
+
+  const __m128i v_zero = _mm_setzero_si128();
+  const __m128i v_big = _mm_set1_epi32(0xffffff);
+  const __m128i v_low_mask = _mm_set1_epi32(~0xff);
+  const __m128i v_bias = _mm_set1_epi32(126);
+  __m128i v_min = _mm_set1_epi32(INT_MAX);
+  __m128i v_max = _mm_set1_epi32(-1);
+  __m128i v_empty = _mm_setzero_si128();
+
+  for (; i + 4 <= count; i += 4) {
+    const __m128 a = _mm_loadu_ps((const float *) &tiles[i]);
+    const __m128 b = _mm_loadu_ps((const float *) &tiles[i] + 4);
+    const __m128 c = _mm_loadu_ps((const float *) &tiles[i] + 8);
+
+    // a = t0 i0 f0 t1, b = i1 f1 t2 i2, c = f2 t3 i3 f3
+    const __m128 ids_01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+    const __m128 ids_23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+    const __m128i ids = _mm_castps_si128(_mm_shuffle_ps(ids_01, ids_23, _MM_SHUFFLE(2, 0, 2, 0)));
+    const __m128 sets_01 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 3, 0));
+    const __m128 sets_23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    const __m128i sets = _mm_castps_si128(_mm_shuffle_ps(sets_01, sets_23, _MM_SHUFFLE(2, 0, 1, 0)));
+
+    const __m128i is_empty = _mm_cmplt_epi32(sets, v_zero);
+    v_empty = _mm_sub_epi32(v_empty, is_empty);
+
+    // Empty cells are replaced by values that can not win
+    const __m128i min_ids = _mm_or_si128(_mm_and_si128(is_empty, _mm_set1_epi32(INT_MAX)), _mm_andnot_si128(is_empty, ids));
+    const __m128i max_ids = _mm_or_si128(is_empty, ids);
+    const __m128i less = _mm_cmplt_epi32(min_ids, v_min);
+    v_min = _mm_or_si128(_mm_and_si128(less, min_ids), _mm_andnot_si128(less, v_min));
+    const __m128i more = _mm_cmpgt_epi32(max_ids, v_max);
+    v_max = _mm_or_si128(_mm_and_si128(more, max_ids), _mm_andnot_si128(more, v_max));
+
+    const __m128i exact = _mm_and_si128(ids, _mm_or_si128(v_low_mask, _mm_cmpgt_epi32(v_big, ids)));
+    __m128i bin = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(exact)), 23), v_bias);
+    bin = _mm_and_si128(bin, _mm_cmpgt_epi32(bin, v_zero));
+
+    int lane_bin[4];
+    int lane_empty[4];
+    _mm_storeu_si128((__m128i *) lane_bin, bin);
+    _mm_storeu_si128((__m128i *) lane_empty, is_empty);
+    for (int k = 0; k < 4; k++) {
+      acc->bins[lane_bin[k]] += 1 + lane_empty[k];
+    }
+  }
+
+  int lane_min[4];
+  int lane_max[4];
+  int lane_empty[4];
+  _mm_storeu_si128((__m128i *) lane_min, v_min);
+  _mm_storeu_si128((__m128i *) lane_max, v_max);
+  _mm_storeu_si128((__m128i *) lane_empty, v_empty);
+  for (int k = 0; k < 4; k++) {
+    if (lane_max[k] >= 0) {
+      acc->min_id = (unsigned) lane_min[k] < acc->min_id ? (unsigned) lane_min[k] : acc->min_id;
+      acc->max_id = (unsigned) lane_max[k] > acc->max_id ? (unsigned) lane_max[k] : acc->max_id;
+    }
+    acc->empty += lane_empty[k];
+  }
+#endif
+
+  for (; i < count; i++) {
+    tile_stats_add(acc, tiles[i]);
+  }
+}
+
+void tile_stats_build(tile_stats *stats, const Tmx::Layer *layer, int width, int height)
+{
+  memset(stats->bins, 0, sizeof(stats->bins));
+
+  tile_stats_acc acc = { ~0u, 0, 0, stats->bins };
+
+  // Dense layers are scanned as one block, chunked ones cell by cell
+  const Tmx::MapTile *data = layer->GetTileData();
+  if (data && width == layer->GetWidth() && height <= layer->GetHeight()) {
+    tile_stats_scan(&acc, data, width * height);
+  }
+  else {
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        tile_stats_add(&acc, layer->GetTile(x, y));
+      }
+    }
+  }
+
+  stats->cells = width * height;
+  stats->empty = acc.empty;
+  stats->min_id = acc.empty < stats->cells ? acc.min_id : 0;
+  stats->max_id = acc.max_id;
+}
+
+int tile_stats_data_size(const tile_stats *stats)
+{
+  if (stats->max_id <= 0xff) {
+    return 1;
+  }
+
+  if (stats->max_id <= 0xffff) {
+    return 2;
+  }
+
+  return 0;
+}
+
+void tile_stats_format(const tile_stats *stats, std::string *text)
+{
+  char line[80];
+
+  if (stats->empty == stats->cells) {
+    snprintf(line, sizeof(line), "no ids, %d cell(s), %d empty\n", stats->cells, stats->empty);
+  }
+  else {
+    snprintf(line, sizeof(line), "ids %u-%u, %d cell(s), %d empty\n", stats->min_id, stats->max_id, stats->cells, stats->empty);
+  }
+  text->append(line);
+
+  for (int i = 0; i < TILE_STATS_BINS; i++) {
+    if (stats->bins[i] == 0) {
+      continue;
+    }
+
+    const unsigned low = i == 0 ? 0 : 1u << (i - 1);
+    const unsigned high = i == 0 ? 0 : low + (low - 1);
+    snprintf(line, sizeof(line), "  %10u-%-10u %d\n", low, high, stats->bins[i]);
+    text->append(line);
+  }
+}
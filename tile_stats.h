@@ -0,0 +1,29 @@
+#ifndef _TILE_STATS_H
+#define _TILE_STATS_H
+
+#include <string>
+#include "Tmx.h"
+
+// Histogram bins by magnitude: bin 0 counts id 0, bin k ids from 2^(k-1) to 2^k - 1
+#define TILE_STATS_BINS 33
+
+// Range and distribution of the ids of the non-empty tiles of one layer, as written to the level
+struct tile_stats
+{
+  unsigned min_id;
+  unsigned max_id;
+  int cells;
+  int empty;
+  int bins[TILE_STATS_BINS];
+};
+
+// Gather the statistics of the width x height cells of a layer in a single pass
+void tile_stats_build(tile_stats *stats, const Tmx::Layer *layer, int width, int height);
+
+// Get the smallest number of bytes per tile that holds every id, 0 if more than two are needed
+int tile_stats_data_size(const tile_stats *stats);
+
+// Append the id range and the non-empty histogram bins as text
+void tile_stats_format(const tile_stats *stats, std::string *text);
+
+#endif
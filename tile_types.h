@@ -1,13 +1,12 @@
 #ifndef _TILE_TYPES_H
 #define _TILE_TYPES_H
 
-#define TILE_TYPE_NONE      0x00
-#define TILE_TYPE_OVERLAY   0x01
-#define TILE_TYPE_FLOOR     0x02
-#define TILE_TYPE_ROCK      0x10
-#define TILE_TYPE_METAL     0x12
-#define TILE_TYPE_SPECIAL_1 0x14
-#define TILE_TYPE_SPECIAL_2 0x16
+// Tile type codes, generated from the tile rows of level_types.def
+enum tile_type
+{
+  TILE_TYPE_NONE = 0x00,
+#define TILE_TYPE(constant, name, code) constant = code,
+#include "level_types.def"
+};
 
 #endif
-
@@ -0,0 +1,47 @@
+#ifndef _TMX2LEV_H
+#define _TMX2LEV_H
+
+#include <stddef.h>
+
+/*
+ * C interface to convert maps in process, linked from libtmx2lev.a or libtmx2lev.so.
+ * Options are the command line options of tmx2lev, such as "--container" or
+ * "--datasize" "auto", so tools and the command line stay in step. Unknown options
+ * and --cache, which only the command line handles, fail the conversion.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Version of this interface, raised only when it changes incompatibly */
+#define TMX2LEV_API_VERSION 1
+
+/* Outcome of a conversion: the level, the messages and the status */
+typedef struct tmx2lev_result tmx2lev_result;
+
+/* Get the version of the interface the library was built with */
+int tmx2lev_api_version(void);
+
+/* Convert TMX text held in memory. base_path is the directory external tilesets are
+   read from, NULL for the current one. Returns NULL only when out of memory. */
+tmx2lev_result *tmx2lev_convert(const char *tmx, size_t size, const char *base_path,
+                                int num_args, const char *const *args);
+
+/* Get 0 when the conversion succeeded, else the error code the command line returns */
+int tmx2lev_result_status(const tmx2lev_result *result);
+
+/* Get the level file, valid until the result is freed */
+const unsigned char *tmx2lev_result_data(const tmx2lev_result *result);
+size_t tmx2lev_result_size(const tmx2lev_result *result);
+
+/* Get every message of the conversion, one per line, as the command line prints them */
+const char *tmx2lev_result_log(const tmx2lev_result *result);
+
+void tmx2lev_result_free(tmx2lev_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#include <new>
+#include <string>
+#include "convert.h"
+#include "tmx2lev.h"
+
+struct tmx2lev_result
+{
+  int status;
+  lev_buffer level;
+  std::string log;
+};
+
+// Messages are kept in the result
+static void log_result(const char *text, void *user)
+{
+  ((tmx2lev_result *) user)->log.append(text);
+}
+
+int tmx2lev_api_version(void)
+{
+  return TMX2LEV_API_VERSION;
+}
+
+tmx2lev_result *tmx2lev_convert(const char *tmx, size_t size, const char *base_path,
+                                int num_args, const char *const *args)
+{
+  tmx2lev_result *result = new (std::nothrow) tmx2lev_result();
+  if (!result) {
+    return NULL;
+  }
+
+  // No exception may leave the C interface
+  try {
+    convert_log log = { log_result, result };
+    convert_options opts;
+    convert_options_init(&opts);
+    if (!convert_parse_options(&opts, num_args, args, &log)) {
+      result->status = 1;
+      return result;
+    }
+
+    // Snapshots are read and written by the command line, the library only gets the text
+    if (opts.cache_name) {
+      convert_printf(&log, "error: --cache is not supported by the library\n");
+      result->status = 1;
+      return result;
+    }
+
+    Tmx::Map map;
+    map.ParseText(std::string(tmx, size), base_path ? base_path : "");
+    if (map.HasError()) {
+      convert_printf(&log, "error code: %d\n", map.GetErrorCode());
+      convert_printf(&log, "error text: %s\n", map.GetErrorText().c_str());
+      result->status = map.GetErrorCode();
+      return result;
+    }
+
+    result->status = convert_level(&map, &opts, &result->level, &log);
+  }
+  catch (const std::exception &e) {
+    result->status = 1;
+    result->level.data.clear();
+    result->log.append("error: ");
+    result->log.append(e.what());
+    result->log.append("\n");
+  }
+  catch (...) {
+    result->status = 1;
+    result->level.data.clear();
+    result->log.append("error: unknown exception\n");
+  }
+
+  return result;
+}
+
+int tmx2lev_result_status(const tmx2lev_result *result)
+{
+  return result->status;
+}
+
+const unsigned char *tmx2lev_result_data(const tmx2lev_result *result)
+{
+  return result->level.data.empty() ? NULL : &result->level.data[0];
+}
+
+size_t tmx2lev_result_size(const tmx2lev_result *result)
+{
+  return result->level.data.size();
+}
+
+const char *tmx2lev_result_log(const tmx2lev_result *result)
+{
+  return result->log.c_str();
+}
+
+void tmx2lev_result_free(tmx2lev_result *result)
+{
+  delete result;
+}
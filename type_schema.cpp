@@ -0,0 +1,215 @@
+#include <string.h>
+#include <vector>
+#include "level_types.h"
+#include "type_schema.h"
+
+struct type_entry
+{
+  const char *name;
+  int code;
+};
+
+static constexpr type_entry tile_entries[] = {
+#define TILE_TYPE(constant, name, code) { name, code },
+#include "level_types.def"
+};
+
+static constexpr type_entry object_entries[] = {
+#define OBJECT_TYPE(constant, name, code) { name, code },
+#include "level_types.def"
+};
+
+static constexpr type_entry area_entries[] = {
+#define AREA_TYPE(constant, name, code) { name, code },
+#include "level_types.def"
+};
+
+static constexpr type_entry direction_entries[] = {
+#define DIRECTION(constant, name, code) { name, code },
+#include "level_types.def"
+};
+
+#define TYPE_COUNT(entries) ((int) (sizeof(entries) / sizeof(entries[0])))
+
+static constexpr bool type_names_equal(const char *a, const char *b)
+{
+  while (*a && *a == *b) {
+    a++;
+    b++;
+  }
+
+  return *a == *b;
+}
+
+// Equal names would keep the seed search below from ever placing both
+static constexpr bool type_names_unique(const type_entry *entries, int count)
+{
+  for (int i = 0; i < count; i++) {
+    for (int j = i + 1; j < count; j++) {
+      if (type_names_equal(entries[i].name, entries[j].name)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static constexpr bool type_codes_unique(const type_entry *entries, int count)
+{
+  for (int i = 0; i < count; i++) {
+    for (int j = i + 1; j < count; j++) {
+      if (entries[i].code == entries[j].code) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static constexpr int type_max_code(const type_entry *entries, int count)
+{
+  int max = -1;
+  for (int i = 0; i < count; i++) {
+    max = entries[i].code > max ? entries[i].code : max;
+  }
+
+  return max;
+}
+
+static_assert(type_names_unique(tile_entries, TYPE_COUNT(tile_entries)), "tile type name defined twice in level_types.def");
+static_assert(type_names_unique(object_entries, TYPE_COUNT(object_entries)), "object type name defined twice in level_types.def");
+static_assert(type_names_unique(area_entries, TYPE_COUNT(area_entries)), "area type name defined twice in level_types.def");
+static_assert(type_names_unique(direction_entries, TYPE_COUNT(direction_entries)), "direction name defined twice in level_types.def");
+static_assert(type_codes_unique(tile_entries, TYPE_COUNT(tile_entries)), "tile type code used twice in level_types.def");
+static_assert(type_codes_unique(object_entries, TYPE_COUNT(object_entries)), "object type code used twice in level_types.def");
+static_assert(type_codes_unique(area_entries, TYPE_COUNT(area_entries)), "area type code used twice in level_types.def");
+static_assert(type_codes_unique(direction_entries, TYPE_COUNT(direction_entries)), "direction code used twice in level_types.def");
+
+// MAX_DIRECTION follows the last direction, which must have the highest code
+static_assert(type_max_code(direction_entries, TYPE_COUNT(direction_entries)) + 1 == MAX_DIRECTION,
+              "MAX_DIRECTION is not one past the highest direction code in level_types.def");
+
+// Slots per name at which the seed search gives up
+#define TYPE_MAX_SLOTS_PER_NAME 256
+
+// Perfect hash table of the names of one kind, slots hold an entry index or -1
+struct type_table
+{
+  const type_entry *entries;
+  unsigned seed;
+  unsigned mask;
+  std::vector<int> slots;
+};
+
+static unsigned type_hash(unsigned seed, const char *str)
+{
+  unsigned hash = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (const unsigned char *p = (const unsigned char *) str; *p; p++) {
+    hash ^= *p;
+    hash *= 16777619u;
+  }
+
+  return hash ^ (hash >> 15);
+}
+
+// Search for a seed that places every name in its own slot, growing the table when no seed is found.
+// Returns false if no seed is found, the table then knows no name.
+static bool type_table_build(type_table *table, const type_entry *entries, int count)
+{
+  table->entries = entries;
+
+  unsigned size = 1;
+  while (size < (unsigned) count * 2) {
+    size <<= 1;
+  }
+
+  for (; size <= (unsigned) count * TYPE_MAX_SLOTS_PER_NAME; size <<= 1) {
+    table->mask = size - 1;
+
+    for (unsigned seed = 0; seed < 4096; seed++) {
+      table->seed = seed;
+      table->slots.assign(size, -1);
+
+      int i;
+      for (i = 0; i < count; i++) {
+        int &slot = table->slots[type_hash(seed, entries[i].name) & table->mask];
+        if (slot >= 0) {
+          break;
+        }
+        slot = i;
+      }
+
+      if (i == count) {
+        return true;
+      }
+    }
+  }
+
+  // Unique names are placed long before this, the schema is checked when it is compiled
+  table->mask = 0;
+  table->slots.assign(1, -1);
+  return false;
+}
+
+struct type_schema
+{
+  type_table tables[MAX_TYPE_KIND];
+  bool built[MAX_TYPE_KIND];
+
+  type_schema()
+  {
+    built[TYPE_KIND_TILE] = type_table_build(&tables[TYPE_KIND_TILE], tile_entries, TYPE_COUNT(tile_entries));
+    built[TYPE_KIND_OBJECT] = type_table_build(&tables[TYPE_KIND_OBJECT], object_entries, TYPE_COUNT(object_entries));
+    built[TYPE_KIND_AREA] = type_table_build(&tables[TYPE_KIND_AREA], area_entries, TYPE_COUNT(area_entries));
+    built[TYPE_KIND_DIRECTION] = type_table_build(&tables[TYPE_KIND_DIRECTION], direction_entries, TYPE_COUNT(direction_entries));
+  }
+};
+
+// Built on first use, which is safe from the parallel world loader
+static const type_schema &get_schema()
+{
+  static const type_schema schema;
+  return schema;
+}
+
+static const type_entry* find_entry(enum type_kind kind, const char *str)
+{
+  const type_table &table = get_schema().tables[kind];
+
+  const int index = table.slots[type_hash(table.seed, str) & table.mask];
+  if (index < 0 || strcmp(table.entries[index].name, str) != 0) {
+    return NULL;
+  }
+
+  return &table.entries[index];
+}
+
+int type_lookup(enum type_kind kind, const char *str, int unknown)
+{
+  const type_entry *entry = find_entry(kind, str);
+  return entry ? entry->code : unknown;
+}
+
+bool type_known(enum type_kind kind, const char *str)
+{
+  return find_entry(kind, str) != NULL;
+}
+
+int type_schema_failed_kind(void)
+{
+  for (int k = 0; k < MAX_TYPE_KIND; k++) {
+    if (!get_schema().built[k]) {
+      return k;
+    }
+  }
+
+  return -1;
+}
+
+const char* type_kind_name(enum type_kind kind)
+{
+  static const char *names[MAX_TYPE_KIND] = { "tile type", "object type", "area type", "direction" };
+  return names[kind];
+}
@@ -0,0 +1,28 @@
+#ifndef _TYPE_SCHEMA_H
+#define _TYPE_SCHEMA_H
+
+// Kinds of named types in the schema of level_types.def
+enum type_kind
+{
+  TYPE_KIND_TILE,
+  TYPE_KIND_OBJECT,
+  TYPE_KIND_AREA,
+  TYPE_KIND_DIRECTION,
+  MAX_TYPE_KIND
+};
+
+// Get the code of a name of a kind, unknown if the schema has no such name.
+// The name is hashed once into a collision-free table and confirmed with a single comparison.
+int type_lookup(enum type_kind kind, const char *str, int unknown);
+
+// Check that a name is in the schema for a kind
+bool type_known(enum type_kind kind, const char *str);
+
+// Get the first kind whose names could not be hashed, whose lookups then all give unknown,
+// or -1 if every kind is usable
+int type_schema_failed_kind(void);
+
+// Get the readable name of a kind, for diagnostics
+const char* type_kind_name(enum type_kind kind);
+
+#endif
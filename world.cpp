@@ -0,0 +1,247 @@
+#include "Tmx.h"
+#include "level_types.h"
+#include "nav_grid.h"
+#include "type_schema.h"
+#include "world.h"
+
+// Parse one map and keep what the world needs of it
+static void load_level(world_level *level, const char *areas_name)
+{
+  // Doors are found by their type name
+  const int failed_kind = type_schema_failed_kind();
+  if (failed_kind >= 0) {
+    level->error = std::string("no perfect hash found for the ") + type_kind_name((enum type_kind) failed_kind) + " names of level_types.def";
+    return;
+  }
+
+  Tmx::Map map;
+  map.ParseFile(level->file_name);
+
+  if (map.HasError()) {
+    level->error = map.GetErrorText();
+    return;
+  }
+
+  if (map.GetNumTilesets() <= 0 || map.GetNumLayers() <= 0) {
+    level->error = "no tileset or no layers";
+    return;
+  }
+
+  const Tmx::Tileset *tileset = map.GetTileset(0);
+  std::vector<tile_attr> attrs;
+  tile_attrs_build(&attrs, tileset, get_max_tiles(tileset));
+
+  std::vector<const Tmx::Layer *> layers;
+  for (int i = 0; i < map.GetNumLayers(); i++) {
+    layers.push_back(map.GetLayer(i));
+  }
+
+  const Tmx::Layer *layer = layers[0];
+  level->width = layer->GetWidth();
+  level->height = layer->GetHeight();
+  level->origin_x = layer->GetOriginX();
+  level->origin_y = layer->GetOriginY();
+  level->tile_width = map.GetTileWidth();
+  level->tile_height = map.GetTileHeight();
+
+  nav_grid grid;
+  nav_grid_build(&grid, layers, attrs, level->width, level->height);
+  level->walkable.swap(grid.walkable);
+
+  // Areas move along with the tiles of cropped infinite maps, as in the level file
+  const int x_shift = layer->GetOriginX() * map.GetTileWidth();
+  const int y_shift = layer->GetOriginY() * map.GetTileHeight();
+
+  const Tmx::ObjectGroup *group = map.FindObjectGroup(areas_name);
+  if (!group) {
+    return;
+  }
+
+  for (int j = 0; j < group->GetNumObjects(); j++) {
+    const Tmx::Object *object = group->GetObject(j);
+    if (get_area_type(object->GetType().c_str()) != AREA_TYPE_DOOR) {
+      continue;
+    }
+
+    const Tmx::PropertySet &prop = object->GetProperties();
+    world_door door;
+    door.area = j;
+    door.x = object->GetX() - x_shift;
+    door.y = object->GetY() - y_shift;
+    door.width = object->GetWidth();
+    door.height = object->GetHeight();
+    door.level = prop.GetNumericProperty(std::string("level"));
+    door.start_x = prop.GetNumericProperty(std::string("start_x"));
+    door.start_y = prop.GetNumericProperty(std::string("start_y"));
+    door.direction = get_direction(prop.GetLiteralProperty(std::string("direction")).c_str());
+    level->doors.push_back(door);
+  }
+}
+
+bool world_load(std::vector<world_level> *levels, const std::vector<std::string> &file_names,
+                const char *areas_name)
+{
+  const int num_levels = file_names.size();
+  levels->assign(num_levels, world_level());
+
+  for (int i = 0; i < num_levels; i++) {
+    (*levels)[i].file_name = file_names[i];
+    (*levels)[i].width = 0;
+    (*levels)[i].height = 0;
+    (*levels)[i].origin_x = 0;
+    (*levels)[i].origin_y = 0;
+    (*levels)[i].tile_width = 0;
+    (*levels)[i].tile_height = 0;
+  }
+
+  const int num_tasks = Tmx::Util::GetNumTasks(num_levels, 1);
+  Tmx::Util::ParallelFor(num_tasks, [&](int task) {
+    for (int i = task; i < num_levels; i += num_tasks) {
+      load_level(&(*levels)[i], areas_name);
+    }
+  });
+
+  bool ok = true;
+  for (int i = 0; i < num_levels; i++) {
+    if (!(*levels)[i].error.empty()) {
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+static bool level_walkable(const world_level *level, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= level->width || y >= level->height) {
+    return false;
+  }
+
+  return level->walkable[y * level->width + x] != 0;
+}
+
+int world_validate(const std::vector<world_level> &levels, convert_log *log)
+{
+  const int num_levels = levels.size();
+  int problems = 0;
+
+  for (int i = 0; i < num_levels; i++) {
+    const world_level *level = &levels[i];
+
+    for (unsigned int j = 0; j < level->doors.size(); j++) {
+      const world_door *door = &level->doors[j];
+
+      // The door must cover a walkable tile to be entered at all
+      bool open = false;
+      for (int y = door->y / level->tile_height; !open && y <= (door->y + door->height - 1) / level->tile_height; y++) {
+        for (int x = door->x / level->tile_width; !open && x <= (door->x + door->width - 1) / level->tile_width; x++) {
+          open = level_walkable(level, x, y);
+        }
+      }
+
+      if (!open) {
+        convert_printf(log, "level %d: door area %d at (%d, %d) covers no walkable tile\n", i, door->area, door->x, door->y);
+        problems++;
+      }
+
+      if (door->level < 0 || door->level >= num_levels) {
+        convert_printf(log, "level %d: door area %d leads to level %d, which is not part of the world\n", i, door->area, door->level);
+        problems++;
+      }
+      else if (!level_walkable(&levels[door->level], door->start_x - levels[door->level].origin_x,
+                               door->start_y - levels[door->level].origin_y)) {
+        convert_printf(log, "level %d: door area %d leads to (%d, %d) of level %d, which is not a walkable tile\n",
+                       i, door->area, door->start_x, door->start_y, door->level);
+        problems++;
+      }
+    }
+  }
+
+  // Levels are entered from level 0 through doors only
+  std::vector<bool> reached(num_levels, false);
+  std::vector<int> queue;
+  if (num_levels > 0) {
+    reached[0] = true;
+    queue.push_back(0);
+  }
+
+  for (unsigned int q = 0; q < queue.size(); q++) {
+    const world_level *level = &levels[queue[q]];
+
+    for (unsigned int j = 0; j < level->doors.size(); j++) {
+      const int next = level->doors[j].level;
+      if (next >= 0 && next < num_levels && !reached[next]) {
+        reached[next] = true;
+        queue.push_back(next);
+      }
+    }
+  }
+
+  for (int i = 0; i < num_levels; i++) {
+    if (!reached[i]) {
+      convert_printf(log, "level %d: %s can not be reached through any door from level 0\n", i, levels[i].file_name.c_str());
+      problems++;
+    }
+  }
+
+  return problems;
+}
+
+void world_write_index(const std::vector<world_level> &levels, lev_buffer *level_buf, lev_buffer *door_buf)
+{
+  int first_door = 0;
+
+  write_word((short) levels.size(), level_buf);
+  for (unsigned int i = 0; i < levels.size(); i++) {
+    const world_level *level = &levels[i];
+
+    write_word((short) level->width, level_buf);
+    write_word((short) level->height, level_buf);
+    write_word((short) level->tile_width, level_buf);
+    write_word((short) level->tile_height, level_buf);
+    write_word((short) first_door, level_buf);
+    write_word((short) level->doors.size(), level_buf);
+    first_door += level->doors.size();
+
+    // Base name of the map, so the game can find the level file, padded to a word boundary
+    std::string name = level->file_name;
+    const size_t slash = name.find_last_of('/');
+    if (slash != std::string::npos) {
+      name = name.substr(slash + 1);
+    }
+    const size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) {
+      name = name.substr(0, dot);
+    }
+
+    write_byte((char) name.size(), level_buf);
+    for (unsigned int k = 0; k < name.size(); k++) {
+      write_byte(name[k], level_buf);
+    }
+    if ((name.size() & 1) == 0) {
+      write_byte(0, level_buf);
+    }
+
+    for (unsigned int j = 0; j < level->doors.size(); j++) {
+      const world_door *door = &level->doors[j];
+
+      // The start moves along with the tiles of the level the door leads to
+      int start_x = door->start_x;
+      int start_y = door->start_y;
+      if (door->level >= 0 && door->level < (int) levels.size()) {
+        start_x -= levels[door->level].origin_x;
+        start_y -= levels[door->level].origin_y;
+      }
+
+      write_word((short) door->area, door_buf);
+      write_word((short) door->x, door_buf);
+      write_word((short) door->y, door_buf);
+      write_word((short) door->width, door_buf);
+      write_word((short) door->height, door_buf);
+      write_word((short) door->level, door_buf);
+      write_word((short) start_x, door_buf);
+      write_word((short) start_y, door_buf);
+      write_word((short) door->direction, door_buf);
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef _WORLD_H
+#define _WORLD_H
+
+#include <string>
+#include <vector>
+#include "convert.h"
+
+// Door area of a level and where it leads, area in pixels and start in tiles. The start is
+// given in tiles of the map the door leads to, before that map is cropped.
+struct world_door
+{
+  int area;
+  int x;
+  int y;
+  int width;
+  int height;
+  int level;
+  int start_x;
+  int start_y;
+  int direction;
+};
+
+// What the world needs to know of one level, its number being its place in the world.
+// The origin is the tile of the map that became the top left tile of a cropped infinite map.
+struct world_level
+{
+  std::string file_name;
+  std::string error;
+  int width;
+  int height;
+  int origin_x;
+  int origin_y;
+  int tile_width;
+  int tile_height;
+  std::vector<unsigned char> walkable;
+  std::vector<world_door> doors;
+};
+
+// Parse the maps of all levels in parallel, keeping their size, walkable cells and doors.
+// Returns false if any map could not be parsed, the error of each level is in its error.
+bool world_load(std::vector<world_level> *levels, const std::vector<std::string> &file_names,
+                const char *areas_name);
+
+// Check every door: that it can be walked into and that it leads to a walkable tile of an
+// existing level. Levels no door path leads to from level 0 are reported as well.
+// Each problem is reported to the log. Returns the number of problems found.
+int world_validate(const std::vector<world_level> &levels, convert_log *log);
+
+// Write the world index, a container with the levels and the doors of every level
+void world_write_index(const std::vector<world_level> &levels, lev_buffer *level_buf, lev_buffer *door_buf);
+
+#endif